@@ -0,0 +1,266 @@
+/**
+ * \file arena.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Headless CPU vs. CPU games.
+ */
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+#include "./arena.h"
+#include "./clock.h"
+#include "./history.h"
+#include "./random.h"
+#include "./scriptpool.h"
+#include "./scriptstats.h"
+
+Arena::Arena(const Opponent::Options &options, const quint8 nWinTowers,
+             QObject *pParent)
+  : QObject(pParent),
+    m_Options(options),
+    m_nNumOfFields(5),
+    m_nMaxTowerHeight(5),
+    m_nMaxStones(20),
+    m_nWinTowers(nWinTowers),
+    m_State(m_nNumOfFields, m_nMaxTowerHeight, m_nMaxStones, m_nWinTowers),
+    m_nErrorPlayer(0),
+    m_bAnswered(false) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+Opponent *Arena::createCpu(const quint8 nID, const QString &sCpu,
+                           const quint64 nSeed) {
+  Opponent::Options options(m_Options);
+  options.nSeed = nSeed;
+  Opponent *pCpu(Opponent::create(nID, sCpu, options, m_nNumOfFields,
+                                  m_nMaxTowerHeight, this));
+  connect(pCpu, SIGNAL(madeMove(Move)),
+          this, SLOT(cpuMove(Move)));
+  connect(pCpu, SIGNAL(scriptError(QString, quint8)),
+          this, SLOT(caughtScriptError(QString, quint8)));
+  return pCpu;
+}
+
+// Evaluates the CPU scripts in advance, the engines are reused by the games
+void Arena::warmUp(const QStringList &sListCpus, const int nCount) const {
+  foreach (const QString &sCpu, sListCpus) {
+    if ("NativeCPU" != sCpu && "MctsCPU" != sCpu) {
+      ScriptPool::instance()->warmUp(sCpu, m_nNumOfFields, m_nMaxTowerHeight,
+                                     nCount);
+    }
+  }
+}
+
+QString Arena::cpuName(const QString &sCpu) {
+  return QFileInfo(sCpu).baseName();
+}
+
+// E.g. "DummyCPU - NativeCPU  0-1  (42 plies, P1 started)"
+QString Arena::resultToString(const QString &sName1, const QString &sName2,
+                              const Result &result,
+                              const quint8 nStartPlayer) {
+  QString sResult(sName1 + " - " + sName2 + "  ");
+  if (0 == result.nWinner) {
+    sResult += "1/2-1/2";
+  } else {
+    sResult += (1 == result.nWinner) ? "1-0" : "0-1";
+  }
+  sResult += "  (" + QString::number(result.nPlies) + " plies, P" +
+             QString::number(nStartPlayer) + " started";
+  if (0 != result.nErrorPlayer) {
+    sResult += ", error P" + QString::number(result.nErrorPlayer);
+  }
+  if (result.bRepetition) {
+    sResult += ", repetition";
+  }
+  if (result.bTimeout) {
+    sResult += ", time";
+  }
+  return sResult + ")";
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+Arena::Result Arena::playGame(const QString &sCpu1, const QString &sCpu2,
+                              const quint8 nStartPlayer,
+                              const quint64 nSeed) {
+  Result result;
+  Random random(nSeed);
+  m_State = GameState(m_nNumOfFields, m_nMaxTowerHeight, m_nMaxStones,
+                      m_nWinTowers);
+  m_State.setCurrentPlayer(nStartPlayer);
+
+  // New opponents for each game, like a new game in the GUI
+  // Both seeds are derived from the game seed, so a game can be replayed
+  const quint64 nSeed1(random.next());
+  const quint64 nSeed2(random.next());
+  Opponent *pCpu[2] = {this->createCpu(1, sCpu1, nSeed1),
+                       this->createCpu(2, sCpu2, nSeed2)};
+  m_nErrorPlayer = 0;
+  for (quint8 nID = 1; nID <= 2; nID++) {
+    if (!pCpu[nID - 1]->initCpu(1 == nID ? sCpu1 : sCpu2)) {
+      result.nErrorPlayer = nID;
+      result.nWinner = 3 - nID;
+      delete pCpu[0];
+      delete pCpu[1];
+      return result;
+    }
+  }
+
+  History history;
+  history.push(m_State.getKey());
+  Clock clock(m_Options.nClockTime, m_Options.nClockIncrement);
+  while (0 == m_State.getWinner() && result.nPlies < m_Options.nMaxPlies) {
+    const quint8 nPlayer(m_State.getCurrentPlayer());
+    if (0 == m_State.findPossibleMoves(nPlayer)) {
+      if (0 == m_State.findPossibleMoves(3 - nPlayer)) {
+        break;  // Tie
+      }
+      // Not counted as ply, like in the GUI, see --max-plies
+      m_State.passTurn();
+      history.push(m_State.getKey());
+      result.moves.append(Move());
+      continue;
+    }
+
+    m_Move = Move();
+    m_bAnswered = false;
+    if (clock.isEnabled()) {
+      pCpu[nPlayer - 1]->setClock(clock.getRemaining(nPlayer),
+                                  clock.getIncrement());
+    }
+    clock.start(nPlayer);
+    pCpu[nPlayer - 1]->makeMoveCpu(m_State);
+    if (!m_bAnswered) {
+      m_WaitLoop.exec();
+    }
+    clock.stop();
+    if (0 != m_nErrorPlayer) {  // Not necessarily the player to move
+      result.nErrorPlayer = m_nErrorPlayer;
+      result.nWinner = 3 - m_nErrorPlayer;
+      break;
+    }
+    const GameState::MoveResult moveResult(m_State.checkMove(m_Move));
+    if (GameState::MoveOk != moveResult) {
+      qWarning() << "CPU" << nPlayer << "made an invalid move:"
+                 << m_State.moveToString(m_Move) << "-"
+                 << GameState::resultToString(moveResult);
+      result.nErrorPlayer = nPlayer;
+      result.nWinner = 3 - nPlayer;
+      break;
+    }
+    if (clock.isEnabled() && clock.getRemaining(nPlayer) <= 0) {
+      qWarning() << "CPU" << nPlayer << "lost on time";
+      result.bTimeout = true;
+      result.nWinner = 3 - nPlayer;
+      break;
+    }
+    m_State.applyMove(m_Move);
+    pCpu[0]->moveApplied(m_Move, nPlayer);
+    pCpu[1]->moveApplied(m_Move, nPlayer);
+    result.nPlies++;
+    result.moves.append(m_Move);
+
+    history.push(m_State.getKey());
+    if (0 != m_Options.nDrawRepetitions &&
+        history.count(m_State.getKey()) >= m_Options.nDrawRepetitions) {
+      result.bRepetition = true;
+      break;
+    }
+  }
+
+  if (0 == result.nErrorPlayer && !result.bTimeout) {
+    result.nWinner = m_State.getWinner();
+  }
+  delete pCpu[0];
+  delete pCpu[1];
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+
+void Arena::cpuMove(const Move &move) {
+  m_Move = move;
+  m_bAnswered = true;
+  m_WaitLoop.quit();
+}
+
+// Also errors of the opponent, which is not to move (move callbacks)
+void Arena::caughtScriptError(const QString &sError, const quint8 nID) {
+  qWarning() << "CPU" << nID << "error:" << sError;
+  if (0 == m_nErrorPlayer) {
+    m_nErrorPlayer = nID;
+  }
+  m_bAnswered = true;
+  m_WaitLoop.quit();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Series of games, start player alternates; prints each game and a summary.
+// Games without error are added to pBook (optional).
+void Arena::run(const QString &sCpu1, const QString &sCpu2, const int nGames,
+                QTextStream *pOut, BookBuilder *pBook) {
+  const QString sName1(cpuName(sCpu1));
+  const QString sName2(cpuName(sCpu2));
+  int nWins[3] = {0, 0, 0};  // Ties, P1, P2
+  int nErrors[3] = {0, 0, 0};
+  qint64 nPlies(0);
+  Random random(m_Options.nSeed);
+  QElapsedTimer timer;
+  timer.start();
+
+  ScriptStats::clearTotals();
+  *pOut << "Seed: " << m_Options.nSeed << endl;
+  for (int i = 0; i < nGames; i++) {
+    const quint8 nStartPlayer(1 + (i & 1));
+    const Result result(this->playGame(sCpu1, sCpu2, nStartPlayer,
+                                       random.next()));
+    nWins[result.nWinner]++;
+    nErrors[result.nErrorPlayer]++;
+    nPlies += result.nPlies;
+    if (NULL != pBook && 0 == result.nErrorPlayer) {
+      pBook->addGame(nStartPlayer, result.moves, result.nWinner);
+    }
+
+    *pOut << "Game " << i + 1 << ": "
+          << resultToString(sName1, sName2, result, nStartPlayer) << endl;
+  }
+
+  const qint64 nElapsed(qMax(Q_INT64_C(1), timer.elapsed()));
+  *pOut << endl
+        << sName1 << " (P1): " << nWins[1] << " won, " << nWins[2]
+        << " lost, " << nWins[0] << " tie, " << nErrors[1] << " errors" << endl
+        << sName2 << " (P2): " << nWins[2] << " won, " << nWins[1]
+        << " lost, " << nWins[0] << " tie, " << nErrors[2] << " errors" << endl
+        << "Average game length: "
+        << static_cast<double>(nPlies) / qMax(1, nGames) << " plies" << endl
+        << "Time: " << nElapsed << " ms (" << nGames * 1000.0 / nElapsed
+        << " games/s)" << endl;
+  ScriptStats::printTotals(pOut);
+}
@@ -0,0 +1,104 @@
+/**
+ * \file arena.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for headless CPU vs. CPU games.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <QEventLoop>
+#include <QObject>
+#include <QTextStream>
+#include <QVector>
+
+#include "./bookbuilder.h"
+#include "./gamestate.h"
+#include "./opponent.h"
+
+/**
+ * \class Arena
+ * \brief Plays CPU vs. CPU games without GUI, dialogs or delays.
+ *
+ * The opponents are called directly one after another; their answer
+ * (setStone / moveTower signal) is collected and validated by GameState.
+ * An invalid move loses the game, a script error loses it for the opponent
+ * reporting it (also from a callback while the other one is to move).
+ * A repeated position (Options::nDrawRepetitions) or too many plies end
+ * it in a tie. With a game clock (Options::nClockTime) a player exceeding
+ * the time loses.
+ */
+class Arena : public QObject {
+  Q_OBJECT
+
+  public:
+    /**
+     * \struct Result
+     * \brief Outcome of one game.
+     */
+    struct Result {
+      Result()
+        : nWinner(0), nPlies(0), nErrorPlayer(0), bRepetition(false),
+          bTimeout(false) {}
+
+      quint8 nWinner;       // 0 = tie
+      quint16 nPlies;
+      quint8 nErrorPlayer;  // Player who lost by an error, or 0
+      bool bRepetition;     // Tie by repeated position
+      bool bTimeout;        // Loser exceeded the game clock
+      QVector<Move> moves;  // Invalid move = pass
+    };
+
+    Arena(const Opponent::Options &options, const quint8 nWinTowers,
+          QObject *pParent = 0);
+    Result playGame(const QString &sCpu1, const QString &sCpu2,
+                    const quint8 nStartPlayer, const quint64 nSeed);
+    void run(const QString &sCpu1, const QString &sCpu2, const int nGames,
+             QTextStream *pOut, BookBuilder *pBook = NULL);
+    void warmUp(const QStringList &sListCpus, const int nCount) const;
+    static QString cpuName(const QString &sCpu);
+    static QString resultToString(const QString &sName1, const QString &sName2,
+                                  const Result &result,
+                                  const quint8 nStartPlayer);
+
+  private slots:
+    void cpuMove(const Move &move);
+    void caughtScriptError(const QString &sError, const quint8 nID);
+
+  private:
+    Opponent *createCpu(const quint8 nID, const QString &sCpu,
+                        const quint64 nSeed);
+
+    const Opponent::Options m_Options;
+    const quint8 m_nNumOfFields;
+    const quint8 m_nMaxTowerHeight;
+    const quint8 m_nMaxStones;
+    const quint8 m_nWinTowers;
+    GameState m_State;
+    Move m_Move;
+    quint8 m_nErrorPlayer;  // First opponent reporting an error, or 0
+    bool m_bAnswered;
+    QEventLoop m_WaitLoop;  // Scripts answer from their own thread
+};
+
+#endif  // ARENA_H_
@@ -31,12 +31,13 @@
 
 #include "./board.h"
 
-Board::Board(quint8 nNumOfFields, quint16 nGridSize,
+Board::Board(const GameState *pState, quint16 nGridSize,
              quint8 nMaxStones, Settings *pSettings)
-  : m_nGridSize(nGridSize),
+  : m_pState(pState),
+    m_nGridSize(nGridSize),
     m_nMaxStones(nMaxStones),
     m_pSettings(pSettings),
-    m_nNumOfFields(nNumOfFields),
+    m_nNumOfFields(pState->getNumOfFields()),
     m_pSvgRenderer(NULL) {
   this->setBackgroundBrush(QBrush(m_pSettings->getBgColor()));
 
@@ -44,20 +45,15 @@ Board::Board(quint8 nNumOfFields, quint16 nGridSize,
   this->createHighlighters();
   this->createStones();
 
-  // Generate field matrix
-  QList<quint8> tower;
-  QList<QList<quint8> > line;
-  QList<QGraphicsSvgItem *> tower2;
-  QList<QList<QGraphicsSvgItem *> > line2;
+  // Generate field matrix (stone items, the stones itself are in m_pState)
+  QList<QGraphicsSvgItem *> tower;
+  QList<QList<QGraphicsSvgItem *> > line;
   for (int i = 0; i < m_nNumOfFields; i++) {
     line.append(tower);
-    line2.append(tower2);
   }
-  m_Fields.clear();
   m_FieldStones.clear();
   for (int i = 0; i < m_nNumOfFields; i++) {
-    m_Fields.append(line);
-    m_FieldStones.append(line2);
+    m_FieldStones.append(line);
   }
 }
 
@@ -176,12 +172,10 @@ void Board::createStones() {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Board::setupSavegame(const QList<QList<QList<quint8> > > board) {
+void Board::setupSavegame() {
   for (int nRow = 0; nRow < m_nNumOfFields; nRow++) {
     for (int nCol = 0; nCol < m_nNumOfFields; nCol++) {
-      foreach (quint8 stone, board[nRow][nCol]) {
-        this->addStone(QPoint(nRow, nCol), stone);
-      }
+      this->updateField(QPoint(nRow, nCol), false);
     }
   }
 
@@ -204,7 +198,8 @@ void Board::mousePressEvent(QGraphicsSceneMouseEvent *p_Event) {
     // qDebug() << "GRID:" << this->getGridField(p_Event->scenePos());
 
     // Place tower, if field is empty
-    if (this->getField(this->getGridField(p_Event->scenePos())).isEmpty()) {
+    if (m_pState->getField(
+          this->getGridField(p_Event->scenePos())).isEmpty()) {
       this->selectField(QPointF(-1, -1));
       emit setStone(this->getGridField(p_Event->scenePos()));
     } else {  // Otherwise select / move tower
@@ -266,39 +261,47 @@ QPoint Board::getGridField(const QPointF point) const {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Board::addStone(const QPoint field, const quint8 stone, const bool bAnim) {
-  quint8 nExisting(m_Fields[field.x()][field.y()].size());
-
-  if (1 == stone) {
-    m_Fields[field.x()][field.y()].append(stone);
-    m_FieldStones[field.x()][field.y()].append(m_listStonesP1.last());
-    m_listStonesP1.removeLast();
-  } else if (2 == stone) {
-    m_Fields[field.x()][field.y()].append(stone);
-    m_FieldStones[field.x()][field.y()].append(m_listStonesP2.last());
-    m_listStonesP2.removeLast();
-  } else {
-    qWarning() << "Trying to set stone type" << stone;
-    QMessageBox::warning(NULL, trUtf8("Warning"),
-                         trUtf8("Something went wrong!"));
-    return;
-  }
+void Board::updateField(const QPoint field, const bool bAnim) {
+  QList<QGraphicsSvgItem *> &fieldStones(m_FieldStones[field.x()][field.y()]);
+  const QList<quint8> tower(m_pState->getField(field));
 
-  if (bAnim) {
-    this->startAnimation(field);
+  // Give back all stone items of this field, afterwards the tower is
+  // rebuilt from the current game state
+  foreach (QGraphicsSvgItem *pStone, fieldStones) {
+    pStone->setVisible(false);
+    if (QLatin1String("Stone1") == pStone->elementId()) {
+      m_listStonesP1.append(pStone);
+    } else {
+      m_listStonesP2.append(pStone);
+    }
   }
+  fieldStones.clear();
+
+  for (int z = 0; z < tower.size(); z++) {
+    if (1 == tower[z]) {
+      fieldStones.append(m_listStonesP1.last());
+      m_listStonesP1.removeLast();
+    } else if (2 == tower[z]) {
+      fieldStones.append(m_listStonesP2.last());
+      m_listStonesP2.removeLast();
+    } else {
+      qWarning() << "Trying to set stone type" << tower[z];
+      QMessageBox::warning(NULL, trUtf8("Warning"),
+                           trUtf8("Something went wrong!"));
+      return;
+    }
 
-  m_FieldStones[field.x()][field.y()].last()->setPos(field*m_nGridSize);
-  m_FieldStones[field.x()][field.y()].last()->setPos(
-        m_FieldStones[field.x()][field.y()].last()->x() - 16 - 13*nExisting,
-      m_FieldStones[field.x()][field.y()].last()->y() + 20 - 13*nExisting);
-  m_FieldStones[field.x()][field.y()].last()->setVisible(true);
-
-  for (int z = 0; z < m_FieldStones[field.x()][field.y()].size(); z++) {
-    m_FieldStones[field.x()][field.y()][z]->setZValue(6 + z);
+    fieldStones.last()->setPos(field*m_nGridSize);
+    fieldStones.last()->setPos(fieldStones.last()->x() - 16 - 13*z,
+                               fieldStones.last()->y() + 20 - 13*z);
+    fieldStones.last()->setZValue(6 + z);
+    fieldStones.last()->setVisible(true);
   }
 
   if (bAnim) {
+    if (!tower.isEmpty()) {
+      this->startAnimation(field);
+    }
     // Redraw board
     this->update(QRectF(0, 0, m_nNumOfFields * m_nGridSize-1,
                         m_nNumOfFields * m_nGridSize-1));
@@ -336,60 +339,6 @@ void Board::resetAnimation2() {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Board::removeStone(const QPoint field, const bool bAll) {
-  if (0 == m_Fields[field.x()][field.y()].size()) {
-    qWarning() << "Trying to remove stone from empty field" << field;
-    QMessageBox::warning(NULL, trUtf8("Warning"),
-                         trUtf8("Something went wrong!"));
-    return;
-  } else if (bAll) {  // Remove all (tower conquered)
-    foreach (quint8 i, m_Fields[field.x()][field.y()]) {
-      // Foreach starts at the beginning of the list
-      if (1 == i) {  // Player 1
-        m_listStonesP1.append(m_FieldStones[field.x()][field.y()].first());
-        m_FieldStones[field.x()][field.y()].first()->setVisible(false);
-        m_FieldStones[field.x()][field.y()].removeFirst();
-      } else {  // Player 2
-        m_listStonesP2.append(m_FieldStones[field.x()][field.y()].first());
-        m_FieldStones[field.x()][field.y()].first()->setVisible(false);
-        m_FieldStones[field.x()][field.y()].removeFirst();
-      }
-    }
-    m_Fields[field.x()][field.y()].clear();
-  } else {  // Remove only one
-    if (1 == m_Fields[field.x()][field.y()].last()) {  // Player 1
-      m_listStonesP1.append(m_FieldStones[field.x()][field.y()].last());
-      m_FieldStones[field.x()][field.y()].last()->setVisible(false);
-      m_FieldStones[field.x()][field.y()].removeLast();
-    } else {  // Player 2
-      m_listStonesP2.append(m_FieldStones[field.x()][field.y()].last());
-      m_FieldStones[field.x()][field.y()].last()->setVisible(false);
-      m_FieldStones[field.x()][field.y()].removeLast();
-    }
-    m_Fields[field.x()][field.y()].removeLast();
-  }
-  // Redraw board
-  this->update(QRectF(0, 0, m_nNumOfFields * m_nGridSize-1,
-                      m_nNumOfFields * m_nGridSize-1));
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-QList<QList<QList<quint8> > > Board::getBoard() const {
-  return m_Fields;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-QList<quint8> Board::getField(const QPoint field) const {
-  return m_Fields[field.x()][field.y()];
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
 void Board::selectField(const QPointF point) {
   static QPoint currentField(QPoint(-1, -1));
   QPointF pointSnap(point);
@@ -406,15 +355,14 @@ void Board::selectField(const QPointF point) {
     return;
   } else {
     QPoint field = this->getGridField(point);
-    if (currentField == field ||
-        0 == m_Fields[field.x()][field.y()].size()) {
+    if (currentField == field || m_pState->getField(field).isEmpty()) {
       currentField = QPoint(-1, -1);
       m_pSelectedField->setVisible(false);
       this->highlightNeighbourhood(neighbours);
       // qDebug() << "Deselected";
       return;
     }
-    neighbours = this->checkNeighbourhood(currentField);
+    neighbours = m_pState->checkNeighbourhood(currentField);
     if (neighbours.contains(field) && m_pSelectedField->isVisible()) {  // Move
       neighbours.clear();
       this->highlightNeighbourhood(neighbours);
@@ -428,7 +376,7 @@ void Board::selectField(const QPointF point) {
       m_pSelectedField->setPos(pointSnap);
       if (m_pSettings->getShowPossibleMoveTowers()) {
         this->highlightNeighbourhood(
-              this->checkNeighbourhood(currentField));
+              m_pState->checkNeighbourhood(currentField));
       }
     }
   }
@@ -437,65 +385,6 @@ void Board::selectField(const QPointF point) {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-QList<QPoint> Board::checkNeighbourhood(const QPoint field) const {
-  QList<QPoint> neighbours;
-  if (QPoint(-1, -1) == field) {
-    return neighbours;
-  }
-
-  quint8 nMoves = m_Fields[field.x()][field.y()].size();
-  // qDebug() << "Selected:" << field << "- Moves:" << nMoves;
-
-  for (int y = field.y() - nMoves; y <= field.y() + nMoves; y += nMoves) {
-    for (int x = field.x() - nMoves; x <= field.x() + nMoves; x += nMoves) {
-      if (x < 0 || y < 0 || x >= m_nNumOfFields || y >= m_nNumOfFields ||
-          field == QPoint(x, y)) {
-        continue;
-      } else if (m_Fields[x][y].size() > 0) {
-        // Check for blocking towers in between
-        QPoint check(x, y);
-        // qDebug() << "POSSIBLE:" << check;
-        QPoint route(field - check);
-        bool bBreak = false;
-
-        for (int i = 1; i < nMoves; i++) {
-          if (route.y() < 0) {
-            check.setY(check.y() - 1);
-          } else if (route.y() > 0) {
-            check.setY(check.y() + 1);
-          } else {
-            check.setY(y);
-          }
-
-          if (route.x() < 0) {
-            check.setX(check.x() - 1);
-          } else if (route.x() > 0) {
-            check.setX(check.x() + 1);
-          } else {
-            check.setX(x);
-          }
-
-          // qDebug() << "Check route:" << check;
-          if (m_Fields[check.x()][check.y()].size() > 0) {
-            // qDebug() << "Route blocked";
-            bBreak = true;
-            break;
-          }
-        }
-
-        if (false == bBreak) {
-          neighbours.append(QPoint(x, y));
-        }
-      }
-    }
-  }
-  // qDebug() << "Neighbours which can be moved:" << neighbours;
-  return neighbours;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
 void Board::highlightNeighbourhood(const QList<QPoint> neighbours) {
   static QList<QGraphicsRectItem *> listPossibleMoves;
 
@@ -517,42 +406,3 @@ void Board::highlightNeighbourhood(const QList<QPoint> neighbours) {
     this->addItem(listPossibleMoves.last());
   }
 }
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-quint8 Board::findPossibleMoves(const bool bStonesLeft) {
-  // Return: 0 = no moves
-  // 1 = stone can be set
-  // 2 = tower can be moved
-  // 3 = stone can be set and tower can be moved
-  quint8 nRet(0);
-
-  for (int y = 0; y < m_nNumOfFields; y++) {
-    for (int x = 0; x < m_nNumOfFields; x++) {
-      if (0 == m_Fields[x][y].size() && bStonesLeft && 1 != nRet) {
-        nRet++;
-      }
-      if (m_Fields[x][y].size() > 0 && 2 != nRet) {
-        if (this->checkNeighbourhood(QPoint(x, y)).size() > 0) {
-          nRet += 2;
-        }
-      }
-      if (3 == nRet) {
-        return nRet;
-      }
-    }
-  }
-  return nRet;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-void Board::printDebugFields() const {
-  qDebug() << "BOARD:";
-  for (int i = 0; i < m_nNumOfFields; i++) {
-    qDebug() << m_Fields[0][i] << m_Fields[1][i] << m_Fields[2][i]
-        << m_Fields[3][i] << m_Fields[4][i];
-  }
-}
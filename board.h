@@ -35,7 +35,8 @@
 #include <QGraphicsSvgItem>
 #include <QPolygonF>
 
-#include <./settings.h>
+#include "./gamestate.h"
+#include "./settings.h"
 
 /**
  * \class Board
@@ -45,19 +46,12 @@ class Board : public QGraphicsScene {
   Q_OBJECT
 
   public:
-    Board(quint8 nNumOfFields, quint16 nGridSize, quint8 nMaxStones,
+    Board(const GameState *pState, quint16 nGridSize, quint8 nMaxStones,
           Settings *pSettings);
 
-    void setupSavegame(const QList<QList<QList<quint8> > > board);
-    void addStone(const QPoint field, const quint8 stone,
-                  const bool bAnim = true);
-    void removeStone(const QPoint field, const bool bAll = false);
+    void setupSavegame();
+    void updateField(const QPoint field, const bool bAnim = true);
     void selectField(const QPointF point);
-    QList<QList<QList<quint8> > > getBoard() const;
-    QList<quint8> getField(const QPoint field) const;
-    quint8 findPossibleMoves(const bool bStonesLeft);
-    QList<QPoint> checkNeighbourhood(const QPoint field) const;
-    void printDebugFields() const;
 
   signals:
     void setStone(QPoint);
@@ -81,6 +75,7 @@ class Board : public QGraphicsScene {
     QPoint getGridField(const QPointF point) const;
     void highlightNeighbourhood(const QList<QPoint> neighbours);
 
+    const GameState *m_pState;
     const quint16 m_nGridSize;
     const quint8 m_nMaxStones;
     Settings *m_pSettings;
@@ -94,7 +89,6 @@ class Board : public QGraphicsScene {
     QList<QGraphicsSvgItem *> m_listStonesP1;
     QList<QGraphicsSvgItem *> m_listStonesP2;
 
-    QList<QList<QList<quint8> > > m_Fields;
     QList<QList<QList<QGraphicsSvgItem *> > > m_FieldStones;
 
     QList<QGraphicsSimpleTextItem *> m_Captions;
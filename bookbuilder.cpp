@@ -0,0 +1,105 @@
+/**
+ * \file bookbuilder.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Opening book generator (statistics of played games).
+ */
+
+#include <QMutexLocker>
+#include <QSet>
+
+#include "./bookbuilder.h"
+
+BookBuilder::BookBuilder(const GameState &rules, const quint8 nPlies)
+  : m_Rules(rules),
+    m_nPlies(qBound(quint8(1), nPlies, static_cast<quint8>(MaxPlies))),
+    m_nGames(0) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// moves: all moves of the game, an invalid move is a pass
+void BookBuilder::addGame(const quint8 nStartPlayer, const QVector<Move> &moves,
+                          const quint8 nWinner) {
+  QMutexLocker locker(&m_Mutex);
+  GameState state(m_Rules);
+  state.setCurrentPlayer(nStartPlayer);
+  m_nGames++;
+
+  for (int i = 0; i < moves.size() && i < m_nPlies; i++) {
+    const Move &move(moves[i]);
+    if (!move.isValid()) {
+      state.passTurn();
+      continue;
+    }
+
+    quint8 nSymmetry(0);
+    const quint64 nKey(state.getCanonicalKey(&nSymmetry));
+    const QPair<quint64, quint16> key(
+          nKey, OpeningBook::packMove(state.transformMove(move, nSymmetry)));
+    int nEntry(m_Index.value(key, -1));
+    if (-1 == nEntry) {
+      nEntry = m_Entries.size();
+      m_Entries.append(OpeningBook::Entry(key.first, key.second));
+      m_Index.insert(key, nEntry);
+    }
+
+    OpeningBook::Entry &entry(m_Entries[nEntry]);
+    if (entry.nGames < 0x7FFF) {  // Points (up to 2 * games) fit in 16 bit
+      entry.nGames++;
+      if (0 == nWinner) {
+        entry.nPoints += 1;
+      } else if (state.getCurrentPlayer() == nWinner) {
+        entry.nPoints += 2;
+      }
+    }
+    state.applyMove(move);
+  }
+}
+
+bool BookBuilder::write(const QString &sFile) const {
+  QMutexLocker locker(&m_Mutex);
+  QVector<OpeningBook::Entry> entries(m_Entries);
+  return OpeningBook::write(sFile, m_Rules, &entries);
+}
+
+// ---------------------------------------------------------------------------
+
+int BookBuilder::getGames() const {
+  QMutexLocker locker(&m_Mutex);
+  return m_nGames;
+}
+
+int BookBuilder::getPositions() const {
+  QMutexLocker locker(&m_Mutex);
+  QSet<quint64> keys;
+  foreach (const OpeningBook::Entry &entry, m_Entries) {
+    keys.insert(entry.nKey);
+  }
+  return keys.size();
+}
+
+int BookBuilder::getMoves() const {
+  QMutexLocker locker(&m_Mutex);
+  return m_Entries.size();
+}
@@ -0,0 +1,70 @@
+/**
+ * \file bookbuilder.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the opening book generator.
+ */
+
+#ifndef BOOKBUILDER_H_
+#define BOOKBUILDER_H_
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include "./gamestate.h"
+#include "./openingbook.h"
+
+/**
+ * \class BookBuilder
+ * \brief Collects the first plies of played games (arena / tournament)
+ *        for an OpeningBook.
+ *
+ * Each move is counted for the canonical position, so the games of all
+ * symmetric openings add up. The result of the game is credited to the
+ * player who made the move. Games may be added from several threads.
+ */
+class BookBuilder {
+  public:
+    enum { MaxPlies = 40 };
+
+    BookBuilder(const GameState &rules, const quint8 nPlies);
+    void addGame(const quint8 nStartPlayer, const QVector<Move> &moves,
+                 const quint8 nWinner);
+    bool write(const QString &sFile) const;
+
+    int getGames() const;
+    int getPositions() const;
+    int getMoves() const;
+
+  private:
+    const GameState m_Rules;
+    const quint8 m_nPlies;
+    QHash<QPair<quint64, quint16>, int> m_Index;
+    QVector<OpeningBook::Entry> m_Entries;
+    int m_nGames;
+    mutable QMutex m_Mutex;
+};
+
+#endif  // BOOKBUILDER_H_
@@ -0,0 +1,116 @@
+/**
+ * \file clock.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Chess clock (base time plus increment) of both players.
+ */
+
+#include "./clock.h"
+
+Clock::Clock(const int nBaseMs, const int nIncrementMs)
+  : m_bEnabled(nBaseMs > 0),
+    m_nIncrement(qMax(0, nIncrementMs)),
+    m_nRunning(0) {
+  m_nRemaining[0] = qMax(0, nBaseMs);
+  m_nRemaining[1] = qMax(0, nBaseMs);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool Clock::isEnabled() const {
+  return m_bEnabled;
+}
+
+// Stops the other player's clock first, a running clock keeps running
+void Clock::start(const quint8 nPlayer) {
+  if (!m_bEnabled || nPlayer == m_nRunning || nPlayer < 1 || nPlayer > 2) {
+    return;
+  }
+  this->stop();
+  m_nRunning = nPlayer;
+  m_Timer.start();
+}
+
+// The increment is only added, if the move was made in time
+void Clock::stop() {
+  if (0 == m_nRunning) {
+    return;
+  }
+  qint64 &nRemaining(m_nRemaining[m_nRunning - 1]);
+  nRemaining -= m_Timer.elapsed();
+  if (nRemaining > 0) {
+    nRemaining += m_nIncrement;
+  }
+  m_nRunning = 0;
+}
+
+quint8 Clock::getRunning() const {
+  return m_nRunning;
+}
+
+// Negative, if the time is up
+qint64 Clock::getRemaining(const quint8 nPlayer) const {
+  if (nPlayer < 1 || nPlayer > 2) {
+    return 0;
+  }
+  qint64 nRemaining(m_nRemaining[nPlayer - 1]);
+  if (nPlayer == m_nRunning) {
+    nRemaining -= m_Timer.elapsed();
+  }
+  return nRemaining;
+}
+
+int Clock::getIncrement() const {
+  return m_nIncrement;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// E.g. "4:05", below 10 seconds with tenths "0:09.3"
+QString Clock::toString(const qint64 nMs) {
+  const qint64 nTime(qMax(Q_INT64_C(0), nMs));
+  QString sTime(QString("%1:%2").arg(nTime / 60000)
+                .arg(nTime / 1000 % 60, 2, 10, QChar('0')));
+  if (nTime < 10000) {
+    sTime += "." + QString::number(nTime / 100 % 10);
+  }
+  return sTime;
+}
+
+// ---------------------------------------------------------------------------
+
+// Time for the next move: the remaining time is spread on MovesToGo moves,
+// most of the increment is used on top. pMaxMs receives the hard limit,
+// which keeps ReserveMs for the overhead of the engine and the game.
+int Clock::allocate(const qint64 nRemainingMs, const int nIncrementMs,
+                    int *pMaxMs) {
+  const qint64 nUsable(qMax(Q_INT64_C(1), nRemainingMs - ReserveMs));
+  const qint64 nTarget(qMin(nUsable,
+                            nUsable / MovesToGo + nIncrementMs * 3 / 4));
+  const qint64 nMax(qMin(nUsable, qMax(nTarget * 4, nUsable / 5)));
+  *pMaxMs = static_cast<int>(qBound(Q_INT64_C(1), nMax,
+                                    Q_INT64_C(0x7FFFFFFF)));
+  return static_cast<int>(qBound(Q_INT64_C(1), nTarget,
+                                 Q_INT64_C(0x7FFFFFFF)));
+}
@@ -0,0 +1,66 @@
+/**
+ * \file clock.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the chess clock of both players.
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <QElapsedTimer>
+#include <QString>
+
+/**
+ * \class Clock
+ * \brief Remaining thinking time of both players (base time + increment).
+ *
+ * Only the running player's time decreases. A move made in time adds the
+ * increment; a player whose time is used up loses the game.
+ * A base time of 0 disables the clock.
+ */
+class Clock {
+  public:
+    enum { MovesToGo = 25, ReserveMs = 50 };
+
+    explicit Clock(const int nBaseMs = 0, const int nIncrementMs = 0);
+
+    bool isEnabled() const;
+    void start(const quint8 nPlayer);
+    void stop();
+    quint8 getRunning() const;
+    qint64 getRemaining(const quint8 nPlayer) const;
+    int getIncrement() const;
+
+    static QString toString(const qint64 nMs);
+    static int allocate(const qint64 nRemainingMs, const int nIncrementMs,
+                        int *pMaxMs);
+
+  private:
+    bool m_bEnabled;
+    qint64 m_nRemaining[2];
+    int m_nIncrement;
+    quint8 m_nRunning;  // 0 = stopped
+    QElapsedTimer m_Timer;
+};
+
+#endif  // CLOCK_H_
@@ -24,10 +24,42 @@
  * Dummy CPU opponent.
  *
  * Variables provided externally from game:
- * jsboard
+ * board (board[x][y] = tower, stones from bottom to top; updated by the
+ *        game - towers and columns are frozen, copy them before changing)
+ * jsboard (same as JSON string, only for compatibility)
  * nID (1 or 2 = player 1 / player 2)
  * nNumOfFields
  * nHeightTowerWin
+ *
+ * makeMove() returns the move as array, object or (old protocol) string:
+ * [x, y] or {to: [x, y]} or "x,y" to set a stone;
+ * [[x, y], [x, y], nStones] or {from: [x, y], to: [x, y], stones: nStones}
+ * or "x,y|x,y|nStones" to move nStones from the first to the second field.
+ *
+ * Optional callbacks, called for the moves of both players:
+ * onSetStone([x, y], nPlayer)
+ * onMove([x, y], [x, y], nStones, nPlayer)
+ * resetGame() - called, if the engine is reused for a new game (nID may
+ *               have changed). Without it, the script is evaluated again.
+ *
+ * Native helpers (moves in the array format above; position handle 0 is
+ * the current position, handles are released before the next makeMove()):
+ * cpu.newPosition(nSource = 0) - copy of a position, returns handle
+ * cpu.freePosition(nHandle)
+ * cpu.legalMoves(nHandle)
+ * cpu.winningMoves(nHandle, nPlayer) - moves conquering a tower for nPlayer
+ * cpu.apply(nHandle, move) / cpu.undo(nHandle) - false if not possible
+ * cpu.currentPlayer(nHandle)
+ * cpu.children(nHandle, scoreFn) - all child positions in one call as flat
+ *   arrays, field index y * nNumOfFields + x, child i starts at
+ *   i * nNumOfFields * nNumOfFields: {count, moves, heights, owners,
+ *   won1, won2, winner}. Optional scoreFn(children) returns an array with
+ *   one score per child, children.scores / children.best are added.
+ * cpu.timeLeft() - ms the current move should take at most with a game
+ *   clock, -1 without clock
+ * cpu.interrupted() - true, if the move exceeded the time limit; with Qt
+ *   before 5.14 all cpu functions (and Math.random()) throw then, a loop
+ *   without any of them is not stopped
  */
 
 cpu.log("Loading CPU script DummyCPU...");
@@ -36,26 +68,25 @@ cpu.log("Loading CPU script DummyCPU...");
 // ---------------------------------------------------------------------------
 
 function makeMove(nPossible) {
-  board = JSON.parse(jsboard);  // Global
   nPossibleMove = Number(nPossible);
   //cpu.log("[0][0][0]: " + board[0][0][0]);
   //cpu.log("[1][0].length: " + board[1][0].length);
   
-  var sMoveToWin = canWin(nID);
-  if (0 !== sMoveToWin.length) {
-    return sMoveToWin;
+  var moveToWin = canWin(nID);
+  if (null !== moveToWin) {
+    return moveToWin;
   }
 
   // Check if opponent can win
   if (2 === nID) {
-    sMoveToWin = canWin(1);
+    moveToWin = canWin(1);
   } else {
-    sMoveToWin = canWin(2);
+    moveToWin = canWin(2);
   }
-  if (0 !== sMoveToWin.length) {
-    var sPreventWin = preventWin(sMoveToWin, nPossibleMove);
-    if (sPreventWin.length > 0) {
-      return sPreventWin;
+  if (null !== moveToWin) {
+    var preventMove = preventWin(moveToWin, nPossibleMove);
+    if (null !== preventMove) {
+      return preventMove;
     }
   }
 
@@ -74,7 +105,7 @@ function makeMove(nPossible) {
 
   // This line never should be reached!
   cpu.log("ERROR: Script couldn't call setStone() / moveTower()!");
-  return "";
+  return null;
 }
 
 // ---------------------------------------------------------------------------
@@ -94,100 +125,27 @@ function moveTower() {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-function checkNeighbourhood(nFieldX, nFieldY)  {
-  var neighbours = [];
-  var nMoves = board[nFieldX][nFieldY].length;
-
-  if (0 === nMoves) {
-    return neighbours;
-  }
-
-  for (var y = nFieldY - nMoves; y <= nFieldY + nMoves; y += nMoves) {
-    for (var x = nFieldX - nMoves; x <= nFieldX + nMoves; x += nMoves) {
-      if (x < 0 || y < 0 || x >= nNumOfFields || y >= nNumOfFields ||
-          (nFieldX === x && nFieldY === y)) {
-        continue;
-      } else if (board[x][y].length > 0) {
-        // Check for blocking towers in between
-        var checkX = x;
-        var checkY = y;
-        var routeX = nFieldX - checkX;
-        var routeY = nFieldY - checkY;
-        var bBreak = false;
-
-        for (var i = 1; i < nMoves; i++) {
-          if (routeY < 0) {
-            checkY = checkY - 1;
-          } else if (routeY > 0) {
-            checkY = checkY + 1;
-          } else {
-            checkY = y;
-          }
-
-          if (routeX < 0) {
-            checkX = checkX - 1;
-          } else if (routeX > 0) {
-            checkX = checkX + 1;
-          } else {
-            checkX = x;
-          }
-
-          if (board[checkX][checkY].length > 0) {
-            // Route blocked
-            bBreak = true;
-            break;
-          }
-        }
-
-        if (false == bBreak) {
-          var point = [x, y];
-          neighbours.push(point);
-        }
-      }
-    }
-  }
-  return neighbours;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
 function canWin(nPlayerID)  {
-  for (var nRow = 0; nRow < nNumOfFields; nRow++) {
-    for (var nCol = 0; nCol < nNumOfFields; nCol++) {
-      var neighbours = checkNeighbourhood(nRow, nCol);
-      // cpu.log("Check: " + (nRow+1) + "," + (nCol+1));
-      // cpu.log("Neighbours: " + neighbours);
-
-      for (var point = 0; point < neighbours.length; point++) {
-        var tower = board[(neighbours[point])[0]][(neighbours[point])[1]];
-        if ((board[nRow][nCol].length + tower.length >= nHeightTowerWin) &&
-            nPlayerID === tower[tower.length - 1]) {  // Top stone = own color
-          return (neighbours[point])[0] + "," + (neighbours[point])[1] + "|" +
-              nRow + "," + nCol + "|" + tower.length;
-        }
-      }
-    }
+  var moves = cpu.winningMoves(0, nPlayerID);
+  if (0 === moves.length) {
+    return null;
   }
-  return "";
+  return moves[0];
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-function preventWin(sMoveToWin, nPossibleMove) {
-  var sMove = sMoveToWin.split("|");
-  var pointFrom = sMove[0].split(",");
-  var pointTo = sMove[1].split(",");
-  var nNumber = sMove[2];
+function preventWin(moveToWin, nPossibleMove) {
+  var pointFrom = moveToWin[0];
+  var pointTo = moveToWin[1];
 
   // Check if a blocking towers in between can be placed
-  var route = [Number(pointTo[0]) - Number(pointFrom[0]),
-               Number(pointTo[1]) - Number(pointFrom[1])];
+  var route = [pointTo[0] - pointFrom[0], pointTo[1] - pointFrom[1]];
   var nMoves = board[pointTo[0]][pointTo[1]].length;
-  var check = [Number(pointFrom[0]), Number(pointFrom[1])];
+  var check = [pointFrom[0], pointFrom[1]];
 
-  // cpu.log("Win? " + sMoveToWin);
+  // cpu.log("Win? " + moveToWin);
   // cpu.log("Route: " + route[0] + "," + route[1]);
   // cpu.log("Moves: " + nMoves);
   // cpu.log("Check 0: " + check[0] + "," + check[1]);
@@ -197,20 +155,20 @@ function preventWin(sMoveToWin, nPossibleMove) {
     for (var i = 1; i < nMoves; i++) {
 
       if (route[1] < 0) {
-        check[1] = Number(check[1] - 1);
+        check[1] = check[1] - 1;
       } else if (route[1] > 0) {
-        check[1] = Number(check[1] + 1);
+        check[1] = check[1] + 1;
       }
 
       if (route[0] < 0) {
-        check[0] = Number(check[0] - 1);
+        check[0] = check[0] - 1;
       } else if (route[0] > 0) {
-        check[0] = Number(check[0] + 1);
+        check[0] = check[0] + 1;
       }
 
       // cpu.log("Check " + i + ": " + check[0] + "," + check[1]);
       if (0 === board[check[0]][check[1]].length) {
-        return check[0] + "," + check[1];
+        return [check[0], check[1]];
       }
     }
   }
@@ -218,38 +176,37 @@ function preventWin(sMoveToWin, nPossibleMove) {
   // TODO: Try to move tower to prevent win
   // }
 
-  return "";
+  return null;
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
 function setRandom() {
-  // Seed random?
+  // Math.random() is seeded by the game (reproducible with --seed)
   do {
     var nRandX = Math.floor(Math.random() * nNumOfFields);
     var nRandY = Math.floor(Math.random() * nNumOfFields);
   } while (0 !== board[nRandX][nRandY].length);
   
-  return nRandX + "," + nRandY;
+  return [nRandX, nRandY];
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
 function moveRandom() {
-  do {
-    var nRandX = Math.floor(Math.random() * nNumOfFields);
-    var nRandY = Math.floor(Math.random() * nNumOfFields);
-    var neighbours = checkNeighbourhood(nRandX, nRandY);
-
-    if (neighbours.length > 0) {
-      var choose = Math.floor(Math.random() * neighbours.length);
-      var tower = board[(neighbours[choose])[0]][(neighbours[choose])[1]];
-      return (neighbours[choose])[0] + "," + (neighbours[choose])[1] + "|" +
-          nRandX + "," + nRandY + "|" + tower.length;
-    }
-  } while (true);
+  var moves = cpu.legalMoves(0).filter(function(move) {
+    return 3 === move.length;
+  });
+  // Prefer moving complete towers
+  var complete = moves.filter(function(move) {
+    return board[move[0][0]][move[0][1]].length === move[2];
+  });
+  if (complete.length > 0) {
+    moves = complete;
+  }
+  return moves[Math.floor(Math.random() * moves.length)];
 }
 
 // ---------------------------------------------------------------------------
@@ -0,0 +1,73 @@
+/**
+ * \file enginerunner.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Worker thread of the native CPUs (alpha-beta search and MCTS).
+ */
+
+#include <QThread>
+
+#include "./enginerunner.h"
+
+EngineRunner::EngineRunner()
+  : QObject(0),
+    m_Quit(0) {
+  qRegisterMetaType<GameState>("GameState");
+  qRegisterMetaType<Move>("Move");
+  qRegisterMetaType<History>("History");
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Moves the runner to a new thread, the runner is deleted with it
+void EngineRunner::start() {
+  QThread *pThread(new QThread());
+  this->moveToThread(pThread);
+  connect(pThread, SIGNAL(finished()), this, SLOT(deleteLater()));
+  pThread->start();
+}
+
+// Ends a running search and the thread; the runner must not be used
+// afterwards
+void EngineRunner::finish() {
+  QThread *pThread(this->thread());
+  m_Quit.store(1);
+  this->interrupt();
+  pThread->quit();
+  pThread->wait();
+  delete pThread;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// An invalid move means, that no move was found
+void EngineRunner::makeMove(const GameState &state, const History &history,
+                            const int nTargetMs, const int nMaxMs,
+                            const quint32 nMoveNo) {
+  if (0 != m_Quit.load()) {
+    return;
+  }
+  const Move move(this->think(state, history, nTargetMs, nMaxMs));
+  emit madeMove(move, nMoveNo);
+}
@@ -0,0 +1,73 @@
+/**
+ * \file enginerunner.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition of the worker thread of the native CPUs.
+ */
+
+#ifndef ENGINERUNNER_H_
+#define ENGINERUNNER_H_
+
+#include <QAtomicInt>
+#include <QObject>
+
+#include "./gamestate.h"
+#include "./history.h"
+
+/**
+ * \class EngineRunner
+ * \brief Search of a native CPU, lives in an own worker thread like the
+ *        ScriptRunner, so the GUI and the game clock keep running while
+ *        the engine thinks.
+ *
+ * The opponent starts a move by a queued makeMove() and receives the
+ * result by madeMove(). Subclasses implement the search in think().
+ */
+class EngineRunner : public QObject {
+  Q_OBJECT
+
+  public:
+    EngineRunner();
+    void start();
+    void finish();
+
+  signals:
+    void madeMove(const Move &move, const quint32 nMoveNo);
+
+  protected:
+    virtual Move think(const GameState &state, const History &history,
+                       const int nTargetMs, const int nMaxMs) = 0;
+    virtual void interrupt() = 0;
+
+  private slots:
+    // Private, only called through a queued connection of the opponent
+    void makeMove(const GameState &state, const History &history,
+                  const int nTargetMs, const int nMaxMs,
+                  const quint32 nMoveNo);
+
+  private:
+    Q_DISABLE_COPY(EngineRunner)
+
+    QAtomicInt m_Quit;
+};
+
+#endif  // ENGINERUNNER_H_
@@ -36,23 +36,33 @@
 
 #include "./game.h"
 
-Game::Game(Settings *pSettings, const QStringList &sListFiles)
+Game::Game(Settings *pSettings, const QStringList &sListFiles,
+           const quint64 nSeed)
   : m_pSettings(pSettings),
     m_pBoard(NULL),
-    m_jsCpuP1(NULL),
-    m_jsCpuP2(NULL),
+    m_pCpuP1(NULL),
+    m_pCpuP2(NULL),
     m_pPlayer1(NULL),
     m_pPlayer2(NULL),
-    m_sJsFileP1(""),
-    m_sJsFileP2(""),
+    m_sCpuP1(""),
+    m_sCpuP2(""),
     m_nMaxTowerHeight(5),
     m_nMaxStones(20),
     m_nGridSize(70),
     m_nNumOfFields(5),
-    m_bScriptError(false) {
-  qDebug() << "Starting new game" << sListFiles;
-
-  m_pBoard = new Board(m_nNumOfFields, m_nGridSize, m_nMaxStones, m_pSettings);
+    m_nDrawRepetitions(pSettings->getDrawRepetitions()),
+    m_nMaxPlies(pSettings->getMaxGamePlies()),
+    m_State(m_nNumOfFields, m_nMaxTowerHeight, m_nMaxStones,
+            pSettings->getWinTowers()),
+    m_nPlies(0),
+    m_Clock(pSettings->getClockTime(), pSettings->getClockIncrement()),
+    m_bScriptError(false),
+    m_bCpuInitialized(false),
+    m_bTimeOver(false),
+    m_Random(nSeed) {
+  qDebug() << "Starting new game" << sListFiles << "- seed:" << nSeed;
+
+  m_pBoard = new Board(&m_State, m_nGridSize, m_nMaxStones, m_pSettings);
   connect(m_pBoard, SIGNAL(setStone(QPoint)),
           this, SLOT(setStone(QPoint)));
   connect(m_pBoard, SIGNAL(moveTower(QPoint, QPoint)),
@@ -63,8 +73,6 @@ Game::Game(Settings *pSettings, const QStringList &sListFiles)
   QString sP2HumanCpu("");
   QString sName2("P2");
   quint8 nStartPlayer(0);
-  quint8 nStonesLeftP1(m_nMaxStones);
-  quint8 nStonesLeftP2(m_nMaxStones);
   quint8 nWonP1(0);
   quint8 nWonP2(0);
 
@@ -128,15 +136,17 @@ Game::Game(Settings *pSettings, const QStringList &sListFiles)
           jsTower = jsLine.at(j).toArray();
           foreach (QJsonValue n, jsTower) {
             tower << n.toDouble();
-            (1 == tower.last()) ? nStonesLeftP1-- : nStonesLeftP2--;
           }
           line.append(tower);
         }
         board.append(line);
       }
 
-      m_pBoard->setupSavegame(board);
-    } else if (sListFiles[0].endsWith(".js", Qt::CaseInsensitive)) {  // 1 CPU
+      m_State.setupBoard(board);
+      m_pBoard->setupSavegame();
+    } else if (sListFiles[0].endsWith(".js", Qt::CaseInsensitive) ||
+               "NativeCPU" == sListFiles[0] ||
+               "MctsCPU" == sListFiles[0]) {  // 1 CPU
       sP1HumanCpu = "Human";
       sName1 = m_pSettings->getNameP1();
       sP2HumanCpu = sListFiles[0];
@@ -164,67 +174,70 @@ Game::Game(Settings *pSettings, const QStringList &sListFiles)
     bP1IsHuman = true;
   } else {
     bP1IsHuman = false;
-    m_sJsFileP1 = sP1HumanCpu;
-    this->createCPU1();
+    m_sCpuP1 = sP1HumanCpu;
+    m_pCpuP1 = this->createCpu(1, m_sCpuP1);
   }
 
   if ("Human" == sP2HumanCpu) {
     bP2IsHuman = true;
   } else {
     bP2IsHuman = false;
-    m_sJsFileP2 = sP2HumanCpu;
-    this->createCPU2();
+    m_sCpuP2 = sP2HumanCpu;
+    m_pCpuP2 = this->createCpu(2, m_sCpuP2);
   }
 
   // Select start player
-  bool bStartPlayer(true);
   if (0 == nStartPlayer) {  // Random
-    nStartPlayer = qrand() % 2 + 1;
-  }
-  if (2 == nStartPlayer) {  // Player 2
-    bStartPlayer = false;
-  } else {  // Player 1
-    bStartPlayer = true;
+    nStartPlayer = m_Random.bounded(2) + 1;
   }
+  m_State.setCurrentPlayer(nStartPlayer);
+  m_State.setWonTowers(1, nWonP1);
+  m_State.setWonTowers(2, nWonP2);
+  m_History.push(m_State.getKey());
 
-  m_pPlayer1 = new Player(bStartPlayer, bP1IsHuman, sName1, m_nMaxStones);
-  m_pPlayer2 = new Player(!bStartPlayer, bP2IsHuman, sName2, m_nMaxStones);
-  m_pPlayer1->setStonesLeft(nStonesLeftP1);
-  m_pPlayer1->setWonTowers(nWonP1);
-  m_pPlayer2->setStonesLeft(nStonesLeftP2);
-  m_pPlayer2->setWonTowers(nWonP2);
-
-  m_sPreviousMove.clear();
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
+  m_pPlayer1 = new Player(bP1IsHuman, sName1);
+  m_pPlayer2 = new Player(bP2IsHuman, sName2);
 
-void Game::createCPU1() {
-  m_jsCpuP1 = new OpponentJS(1, m_nNumOfFields, m_nMaxTowerHeight);
-  connect(this, SIGNAL(makeMoveCpuP1(QList<QList<QList<quint8> > >, quint8)),
-          m_jsCpuP1, SLOT(makeMoveCpu(QList<QList<QList<quint8> > >, quint8)));
-  connect(m_jsCpuP1, SIGNAL(setStone(QPoint)),
-          this, SLOT(setStone(QPoint)));
-  connect(m_jsCpuP1, SIGNAL(moveTower(QPoint, QPoint, quint8)),
-          this, SLOT(moveTower(QPoint, QPoint, quint8)));
-  connect(m_jsCpuP1, SIGNAL(scriptError()),
-          this, SLOT(caughtScriptError()));
+  if (m_Clock.isEnabled()) {
+    connect(&m_ClockTimer, SIGNAL(timeout()), this, SLOT(updateClocks()));
+    m_ClockTimer.start(200);
+  }
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Game::createCPU2() {
-  m_jsCpuP2 = new OpponentJS(2, m_nNumOfFields, m_nMaxTowerHeight);
-  connect(this, SIGNAL(makeMoveCpuP2(QList<QList<QList<quint8> > >, quint8)),
-          m_jsCpuP2, SLOT(makeMoveCpu(QList<QList<QList<quint8> > >, quint8)));
-  connect(m_jsCpuP2, SIGNAL(setStone(QPoint)),
-          this, SLOT(setStone(QPoint)));
-  connect(m_jsCpuP2, SIGNAL(moveTower(QPoint, QPoint, quint8)),
-          this, SLOT(moveTower(QPoint, QPoint, quint8)));
-  connect(m_jsCpuP2, SIGNAL(scriptError()),
-          this, SLOT(caughtScriptError()));
+Opponent *Game::createCpu(const quint8 nID, const QString &sCpu) {
+  Opponent::Options options;
+  options.nSearchDepth = m_pSettings->getSearchDepth();
+  options.nSearchTime = m_pSettings->getSearchTime();
+  options.nThreads = m_pSettings->getSearchThreads();
+  options.nHashSizeMB = m_pSettings->getSearchHashSize();
+  options.nHashReplacement = m_pSettings->getSearchHashReplacement();
+  options.nScriptTimeLimit = m_pSettings->getScriptTimeLimit();
+  options.nScriptMemoryMB = m_pSettings->getScriptMemoryLimit();
+  options.bScriptGc = m_pSettings->getScriptGarbageCollection();
+  options.sTablebase = m_pSettings->getTablebase();
+  options.sBook = m_pSettings->getOpeningBook();
+  options.nSeed = m_Random.next();
+  // Deleted with the game, this ends the engine threads
+  Opponent *pCpu(Opponent::create(nID, sCpu, options,
+                                  m_nNumOfFields, m_nMaxTowerHeight, this));
+
+  if (1 == nID) {
+    connect(this, SIGNAL(makeMoveCpuP1(GameState)),
+            pCpu, SLOT(makeMoveCpu(GameState)));
+  } else {
+    connect(this, SIGNAL(makeMoveCpuP2(GameState)),
+            pCpu, SLOT(makeMoveCpu(GameState)));
+  }
+  connect(this, SIGNAL(moveApplied(Move, quint8)),
+          pCpu, SLOT(moveApplied(Move, quint8)));
+  connect(pCpu, SIGNAL(madeMove(Move)),
+          this, SLOT(cpuMove(Move)));
+  connect(pCpu, SIGNAL(scriptError(QString, quint8)),
+          this, SLOT(caughtScriptError(QString)));
+  return pCpu;
 }
 
 // ---------------------------------------------------------------------------
@@ -232,19 +245,25 @@ void Game::createCPU2() {
 
 bool Game::initCpu() {
   if (!m_pPlayer1->getIsHuman()) {
-    if (!m_jsCpuP1->loadAndEvalCpuScript(m_sJsFileP1)) {
+    if (!m_pCpuP1->initCpu(m_sCpuP1)) {
       return false;
     }
   }
   if (!m_pPlayer2->getIsHuman()) {
-    if (!m_jsCpuP2->loadAndEvalCpuScript(m_sJsFileP2)) {
+    if (!m_pCpuP2->initCpu(m_sCpuP2)) {
       return false;
     }
   }
+  m_bCpuInitialized = true;
   return true;
 }
 
-void Game::caughtScriptError() {
+void Game::caughtScriptError(const QString &sError) {
+  m_Clock.stop();
+  // Errors during the initialization are reported by the caller of initCpu()
+  if (m_bCpuInitialized && !m_bScriptError && !m_bTimeOver) {
+    emit cpuError(trUtf8("CPU script error: %1").arg(sError));
+  }
   m_bScriptError = true;
 }
 
@@ -264,75 +283,37 @@ QRectF Game::getSceneRect() const {
 // ---------------------------------------------------------------------------
 
 void Game::setStone(QPoint field) {
-  QString sMove(static_cast<char>(field.x() + 65)
-                + QString::number(field.y() + 1));
-
-  if (0 == m_pBoard->getField(field).size()) {
-    if (m_pPlayer1->getIsActive() && m_pPlayer1->getStonesLeft() > 0) {
-      m_pPlayer1->setStonesLeft(m_pPlayer1->getStonesLeft() - 1);
-      m_pBoard->addStone(field, 1);
-      qDebug() << "P1 >>" << sMove;
-    } else if (m_pPlayer2->getIsActive() && m_pPlayer2->getStonesLeft() > 0) {
-      m_pPlayer2->setStonesLeft(m_pPlayer2->getStonesLeft() - 1);
-      m_pBoard->addStone(field, 2);
-      qDebug() << "P2 >>" << sMove;
-    } else {
-      if ((m_pPlayer1->getIsActive() && m_pPlayer1->getIsHuman()) ||
-          (m_pPlayer2->getIsActive() && m_pPlayer2->getIsHuman())) {
-        QMessageBox::information(
-              NULL, trUtf8("Information"),
-              trUtf8("No stones left! Please move a tower."));
-      } else {
-        m_bScriptError = true;
-        qWarning() << "CPU tried to set stone, but no stones left!";
-        QMessageBox::warning(NULL, trUtf8("Warning"),
-                             trUtf8("CPU script made an invalid move! "
-                                    "Please check the debug log."));
-      }
-      return;
-    }
-    m_sPreviousMove.clear();
+  const Move move(-1, m_State.fieldIndex(field), 1);
+  const GameState::MoveResult result(m_State.checkMove(move));
 
-    this->checkTowerWin(field);
-    this->updatePlayers();
-  } else {
-    if ((m_pPlayer1->getIsActive() && m_pPlayer1->getIsHuman()) ||
-        (m_pPlayer2->getIsActive() && m_pPlayer2->getIsHuman())) {
-      QMessageBox::information(NULL, trUtf8("Information"),
-                               trUtf8("It is only allowed to place a "
-                                      "stone on a free field."));
-    } else {
-      m_bScriptError = true;
-      qWarning() << "CPU tried to set stone >>" << sMove;
-      QMessageBox::warning(NULL, trUtf8("Warning"),
-                           trUtf8("CPU script made an invalid move! "
-                                  "Please check the debug log."));
-    }
+  if (GameState::NoStonesLeft == result) {
+    QMessageBox::information(NULL, trUtf8("Information"),
+                             trUtf8("No stones left! Please move a tower."));
+    return;
+  } else if (GameState::MoveOk != result) {
+    QMessageBox::information(NULL, trUtf8("Information"),
+                             trUtf8("It is only allowed to place a "
+                                    "stone on a free field."));
+    return;
   }
+
+  this->makeMove(move);
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Game::moveTower(QPoint tower, QPoint moveTo, quint8 nStones) {
-  QList<quint8> listStones(m_pBoard->getField(tower));
+void Game::moveTower(QPoint tower, QPoint moveTo) {
+  QList<quint8> listStones(m_State.getField(tower));
   if (0 == listStones.size()) {
     qWarning() << "Move tower size == 0! Tower:" << tower;
-    if ((m_pPlayer1->getIsActive() && m_pPlayer1->getIsHuman()) ||
-        (m_pPlayer2->getIsActive() && m_pPlayer2->getIsHuman())) {
-      QMessageBox::warning(NULL, trUtf8("Warning"),
-                           trUtf8("Something went wrong!"));
-    } else {
-      m_bScriptError = true;
-      QMessageBox::warning(NULL, trUtf8("Warning"),
-                           trUtf8("CPU script made an invalid move! "
-                                  "Please check the debug log."));
-    }
+    QMessageBox::warning(NULL, trUtf8("Warning"),
+                         trUtf8("Something went wrong!"));
     return;
   }
 
   int nStonesToMove = 1;
-  if (listStones.size() > 1 && 0 == nStones) {
+  if (listStones.size() > 1) {
     bool ok;
     nStonesToMove = QInputDialog::getInt(
                       NULL, trUtf8("Move tower"),
@@ -341,139 +322,132 @@ void Game::moveTower(QPoint tower, QPoint moveTo, quint8 nStones) {
     if (!ok) {
       return;
     }
-  } else if (0 != nStones) {  // Call from CPU
-    if (nStones > listStones.size()) {
-      qWarning() << "Trying to move more stones than available! From:" << tower
-                 << "Stones:" << nStones << "To:" << moveTo;
-      if ((m_pPlayer1->getIsActive() && m_pPlayer1->getIsHuman()) ||
-          (m_pPlayer2->getIsActive() && m_pPlayer2->getIsHuman())) {
-        QMessageBox::warning(NULL, trUtf8("Warning"),
-                             trUtf8("Something went wrong!"));
-      } else {
-        m_bScriptError = true;
-        QMessageBox::warning(NULL, trUtf8("Warning"),
-                             trUtf8("CPU script made an invalid move! "
-                                    "Please check the debug log."));
-      }
-      return;
-    } else {
-      nStonesToMove = nStones;
-    }
-  }
-
-  // Debug print: E.g. "C4:3-D3" = move 3 stones from C4 to D3 (ASCII 65 = A)
-  QString sMove(static_cast<char>(tower.x() + 65) +
-                QString::number(tower.y() + 1) + ":" +
-                QString::number(nStonesToMove) + "-" +
-                static_cast<char>(moveTo.x() + 65) +
-                QString::number(moveTo.y() + 1));
-
-  if (m_pPlayer1->getIsActive()) {
-    qDebug() << "P1 >>" << sMove;
-    if (!m_pPlayer1->getIsHuman()) {
-      m_pBoard->selectField(moveTo);
-      m_pBoard->selectField(QPoint(-1, -1));
-    }
-  } else {
-    qDebug() << "P2 >>" << sMove;
-    if (!m_pPlayer2->getIsHuman()) {
-      m_pBoard->selectField(moveTo);
-      m_pBoard->selectField(QPoint(-1, -1));
-    }
   }
 
-  if (this->checkPreviousMoveReverted(sMove)) {
-    if ((m_pPlayer1->getIsActive() && !m_pPlayer1->getIsHuman()) ||
-        (m_pPlayer2->getIsActive() && !m_pPlayer2->getIsHuman())) {
-      m_bScriptError = true;
-      qWarning() << "CPU tried to revert previous move.";
-      QMessageBox::warning(NULL, trUtf8("Warning"),
-                           trUtf8("CPU script made an invalid move! "
-                                  "Please check the debug log."));
-    }
+  const Move move(m_State.fieldIndex(tower), m_State.fieldIndex(moveTo),
+                  nStonesToMove);
+  const GameState::MoveResult result(m_State.checkMove(move));
+  if (GameState::RevertsPreviousMove == result) {
     QMessageBox::information(NULL, trUtf8("Information"),
                              trUtf8("It is not allowed to revert the "
                                     "previous oppenents move directly!"));
     return;
+  } else if (GameState::MoveOk != result) {
+    qWarning() << "Invalid move" << m_State.moveToString(move) << "-"
+               << GameState::resultToString(result);
+    return;
   }
 
-  // Check, if CPU made a valid move
-  if (!m_pBoard->checkNeighbourhood(moveTo).contains(tower)) {
-    qWarning() << "CPU tried to move a tower, which is not in the "
-                  "neighbourhood of the selected tower.";
-    m_bScriptError = true;
-    QMessageBox::warning(NULL, trUtf8("Warning"),
-                         trUtf8("CPU script made an invalid move! "
-                                "Please check the debug log."));
+  this->makeMove(move);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Game::cpuMove(const Move &move) {
+  if (m_bTimeOver) {  // Late answer of a CPU
+    return;
+  }
+  if (this->isHumanActive()) {
+    qWarning() << "Ignoring CPU move while human player is active:"
+               << m_State.moveToString(move);
     return;
   }
 
-  for (int i = 0; i < nStonesToMove; i++) {
-    m_pBoard->removeStone(tower);  // Remove is in the wrong order, nevermind!
-    m_pBoard->addStone(moveTo,
-                       listStones[listStones.size() - nStonesToMove + i]);
+  // Illegal moves are reported as error, the CPU stops playing
+  const GameState::MoveResult result(m_State.checkMove(move));
+  if (GameState::MoveOk != result) {
+    qWarning() << "CPU" << m_State.getCurrentPlayer() << "made an invalid move:"
+               << m_State.moveToString(move) << "-"
+               << GameState::resultToString(result);
+    this->caughtScriptError(trUtf8("Invalid move %1 (%2)")
+                            .arg(m_State.moveToString(move))
+                            .arg(GameState::resultToString(result)));
+    this->updatePlayers();
+    return;
   }
 
-  this->checkTowerWin(moveTo);
-  this->updatePlayers();
+  if (!move.isSetStone()) {
+    m_pBoard->selectField(m_State.fieldPoint(move.nTo));
+    m_pBoard->selectField(QPoint(-1, -1));
+  }
+  this->makeMove(move);
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Game::checkTowerWin(QPoint field) {
-  if (m_pBoard->getField(field).size() >= m_nMaxTowerHeight) {
-    if (1 == m_pBoard->getField(field).last()) {
-      m_pPlayer1->setWonTowers(m_pPlayer1->getWonTowers() + 1);
-      qDebug() << "Player 1 conquered tower" <<
-                  static_cast<char>(field.x() + 65) +
-                  QString::number(field.y() + 1);
-      if (m_pSettings->getWinTowers() != m_pPlayer1->getWonTowers()) {
-        QMessageBox::information(NULL, trUtf8("Information"),
-                                 trUtf8("%1 conquered a tower!")
-                                 .arg(m_pPlayer1->getName()));
-      }
-    } else if (2 == m_pBoard->getField(field).last()) {
-      m_pPlayer2->setWonTowers(m_pPlayer2->getWonTowers() + 1);
-      qDebug() << "Player 2 conquered tower" <<
-                  static_cast<char>(field.x() + 65) +
-                  QString::number(field.y() + 1);
-      if (m_pSettings->getWinTowers() != m_pPlayer2->getWonTowers()) {
-        QMessageBox::information(NULL, trUtf8("Information"),
-                                 trUtf8("%1 conquered a tower!")
-                                 .arg(m_pPlayer2->getName()));
-      }
-    } else {
-      qDebug() << Q_FUNC_INFO;
-      qWarning() << "Last stone neither 1 nor 2!";
-      qWarning() << "Field:" << field
-                 << " -  Tower" << m_pBoard->getField(field);
-      QMessageBox::warning(NULL, trUtf8("Warning"),
-                           trUtf8("Something went wrong!"));
-      return;
-    }
-    this->returnStones(field);
+// Debug print: E.g. "C4:3-D3" = move 3 stones from C4 to D3
+void Game::makeMove(const Move &move) {
+  // Loss on time since the last tick of the clock timer, e.g. while the
+  // dialog for the number of stones was open
+  this->updateClocks();
+  if (m_bTimeOver) {
+    qWarning() << "Ignoring move after loss on time:"
+               << m_State.moveToString(move);
+    return;
+  }
+  if (1 == m_State.getCurrentPlayer()) {
+    qDebug() << "P1 >>" << m_State.moveToString(move);
+  } else {
+    qDebug() << "P2 >>" << m_State.moveToString(move);
   }
+  this->applyMove(move);
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Game::returnStones(QPoint field) {
-  QList<quint8> tower(m_pBoard->getField(field));
-  quint8 stones(tower.count(1));
-  m_pPlayer1->setStonesLeft(m_pPlayer1->getStonesLeft() + stones);
-  stones = tower.count(2);
-  m_pPlayer2->setStonesLeft(m_pPlayer2->getStonesLeft() + stones);
+void Game::applyMove(const Move &move) {
+  const quint8 nWonP1(m_State.getWonTowers(1));
+  const quint8 nWonP2(m_State.getWonTowers(2));
+  const quint8 nPlayer(m_State.getCurrentPlayer());
+
+  m_Clock.stop();
+  m_State.applyMove(move);
+  m_History.push(m_State.getKey());
+  m_nPlies++;
+  emit moveApplied(move, nPlayer);
+  if (!move.isSetStone()) {
+    m_pBoard->updateField(m_State.fieldPoint(move.nFrom), false);
+  }
+  m_pBoard->updateField(m_State.fieldPoint(move.nTo));
+
+  this->checkTowerWin(m_State.fieldPoint(move.nTo), nWonP1, nWonP2);
+  this->updatePlayers();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
 
-  // Clear field
-  m_pBoard->removeStone(field, true);
+void Game::checkTowerWin(const QPoint field,
+                         const quint8 nWonP1, const quint8 nWonP2) {
+  // Conquered towers are removed and returned already by the game state
+  if (nWonP1 != m_State.getWonTowers(1)) {
+    qDebug() << "Player 1 conquered tower" <<
+                static_cast<char>(field.x() + 65) +
+                QString::number(field.y() + 1);
+    if (m_State.getWinTowers() != m_State.getWonTowers(1)) {
+      QMessageBox::information(NULL, trUtf8("Information"),
+                               trUtf8("%1 conquered a tower!")
+                               .arg(m_pPlayer1->getName()));
+    }
+  } else if (nWonP2 != m_State.getWonTowers(2)) {
+    qDebug() << "Player 2 conquered tower" <<
+                static_cast<char>(field.x() + 65) +
+                QString::number(field.y() + 1);
+    if (m_State.getWinTowers() != m_State.getWonTowers(2)) {
+      QMessageBox::information(NULL, trUtf8("Information"),
+                               trUtf8("%1 conquered a tower!")
+                               .arg(m_pPlayer2->getName()));
+    }
+  }
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Game::updatePlayers(bool bInitial) {
+void Game::updatePlayers() {
   if (m_bScriptError) {
     emit setInteractive(false);
     return;
@@ -481,137 +455,167 @@ void Game::updatePlayers(bool bInitial) {
 
   emit updateNameP1(m_pPlayer1->getName());
   emit updateNameP2(m_pPlayer2->getName());
-  emit updateStonesP1(QString::number(m_pPlayer1->getStonesLeft()));
-  emit updateStonesP2(QString::number(m_pPlayer2->getStonesLeft()));
-  emit updateWonP1(QString::number(m_pPlayer1->getWonTowers()));
-  emit updateWonP2(QString::number(m_pPlayer2->getWonTowers()));
+  emit updateStonesP1(this->stonesText(1));
+  emit updateStonesP2(this->stonesText(2));
+  emit updateWonP1(QString::number(m_State.getWonTowers(1)));
+  emit updateWonP2(QString::number(m_State.getWonTowers(2)));
 
-  if (m_pSettings->getWinTowers() == m_pPlayer1->getWonTowers()) {
+  if (1 == m_State.getWinner()) {
     qDebug() << "PLAYER 1 WON!";
     emit setInteractive(false);
     emit highlightActivePlayer(false, true);
     QMessageBox::information(NULL, trUtf8("Information"),
                              trUtf8("%1 won the game!")
                              .arg(m_pPlayer1->getName()));
-  } else if (m_pSettings->getWinTowers() == m_pPlayer2->getWonTowers()) {
+  } else if (2 == m_State.getWinner()) {
     qDebug() << "PLAYER 2 WON!";
     emit setInteractive(false);
     emit highlightActivePlayer(false, false, true);
     QMessageBox::information(NULL, trUtf8("Information"),
                              trUtf8("%1 won the game!")
                              .arg(m_pPlayer2->getName()));
+  } else if (this->checkTie()) {
+    emit setInteractive(false);
   } else {
-    if (!bInitial) {
-      m_pPlayer1->setActive(!m_pPlayer1->getIsActive());
-      m_pPlayer2->setActive(!m_pPlayer2->getIsActive());
-    }
-    emit highlightActivePlayer(m_pPlayer1->getIsActive());
-    this->checkPossibleMoves();
-
-    if ((m_pPlayer1->getIsActive() && !m_pPlayer1->getIsHuman()) ||
-        (m_pPlayer2->getIsActive() && !m_pPlayer2->getIsHuman())) {
-      emit setInteractive(false);
-      QTimer::singleShot(800, this, SLOT(delayCpu()));
-    } else {
-      emit setInteractive(true);
+    emit highlightActivePlayer(1 == m_State.getCurrentPlayer());
+    if (this->checkPossibleMoves()) {
+      if (!this->isHumanActive()) {
+        emit setInteractive(false);
+        QTimer::singleShot(800, this, SLOT(delayCpu()));
+      } else {
+        emit setInteractive(true);
+        m_Clock.start(m_State.getCurrentPlayer());
+      }
     }
   }
 
-  m_pBoard->printDebugFields();
+  m_State.printDebugFields();
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
+// The clock of the CPU starts after the delay, it is not charged for it
 void Game::delayCpu() {
-  if (m_pPlayer1->getIsActive()) {
-    emit makeMoveCpuP1(m_pBoard->getBoard(), m_pPlayer1->getCanMove());
+  const quint8 nPlayer(m_State.getCurrentPlayer());
+  if (m_Clock.isEnabled()) {
+    Opponent *pCpu(1 == nPlayer ? m_pCpuP1 : m_pCpuP2);
+    pCpu->setClock(m_Clock.getRemaining(nPlayer), m_Clock.getIncrement());
+    m_Clock.start(nPlayer);
+  }
+
+  if (1 == nPlayer) {
+    emit makeMoveCpuP1(m_State);
   } else {
-    emit makeMoveCpuP2(m_pBoard->getBoard(), m_pPlayer2->getCanMove());
+    emit makeMoveCpuP2(m_State);
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+// Remaining stones, with game clock followed by the remaining time
+QString Game::stonesText(const quint8 nPlayer) const {
+  const QString sStones(QString::number(m_State.getStonesLeft(nPlayer)));
+  if (!m_Clock.isEnabled()) {
+    return sStones;
+  }
+  return QString("%1  (%2)").arg(sStones)
+      .arg(Clock::toString(m_Clock.getRemaining(nPlayer)));
+}
+
+void Game::updateClocks() {
+  const quint8 nPlayer(m_Clock.getRunning());
+  if (0 == nPlayer) {
+    return;
+  }
+  emit updateStonesP1(this->stonesText(1));
+  emit updateStonesP2(this->stonesText(2));
+  if (m_Clock.getRemaining(nPlayer) > 0) {
+    return;
   }
+
+  m_Clock.stop();
+  m_ClockTimer.stop();
+  m_bTimeOver = true;
+  emit updateStonesP1(this->stonesText(1));
+  emit updateStonesP2(this->stonesText(2));
+  emit setInteractive(false);
+  emit highlightActivePlayer(false, 2 == nPlayer, 1 == nPlayer);
+  qDebug() << "PLAYER" << nPlayer << "LOST ON TIME!";
+  QMessageBox::information(NULL, trUtf8("Information"),
+                           trUtf8("%1 lost on time!")
+                           .arg(1 == nPlayer ? m_pPlayer1->getName()
+                                             : m_pPlayer2->getName()));
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Game::checkPossibleMoves() {
-  if (m_pPlayer1->getIsActive()) {
-    m_pPlayer1->setCanMove(
-          m_pBoard->findPossibleMoves(m_pPlayer1->getStonesLeft() > 0));
-    if (0 != m_pPlayer1->getCanMove()) {
-      return;
-    }
-  } else {
-    m_pPlayer2->setCanMove(
-          m_pBoard->findPossibleMoves(m_pPlayer2->getStonesLeft() > 0));
-    if (0 != m_pPlayer2->getCanMove()) {
-      return;
-    }
+bool Game::checkPossibleMoves() {
+  const quint8 nPlayer(m_State.getCurrentPlayer());
+  if (0 != m_State.findPossibleMoves(nPlayer)) {
+    return true;
   }
 
-  if (0 == m_pPlayer1->getCanMove() && 0 == m_pPlayer2->getCanMove()) {
+  if (0 == m_State.findPossibleMoves(3 - nPlayer)) {
     emit setInteractive(false);
     qDebug() << "NO MOVES POSSIBLE ANYMORE!";
     QMessageBox::information(NULL, trUtf8("Information"),
                              trUtf8("No moves possible anymore.\n"
                                     "Game ends in a tie!"));
-  } else if (0 == m_pPlayer1->getCanMove()) {
+  } else if (1 == nPlayer) {
     qDebug() << "PLAYER 1 HAS TO PASS!";
     QMessageBox::information(NULL, trUtf8("Information"),
                              trUtf8("No move possible!\n%1 has to pass.")
                              .arg(m_pPlayer1->getName()));
+    m_State.passTurn();
+    m_History.push(m_State.getKey());
     this->updatePlayers();
-  } else if (0 == m_pPlayer2->getCanMove()) {
+  } else {
     qDebug() << "PLAYER 2 HAS TO PASS!";
     QMessageBox::information(NULL, trUtf8("Information"),
                              trUtf8("No move possible!\n%1 has to pass.")
                              .arg(m_pPlayer2->getName()));
+    m_State.passTurn();
+    m_History.push(m_State.getKey());
     this->updatePlayers();
   }
+  return false;
 }
 
-// ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-bool Game::checkPreviousMoveReverted(const QString sMove) {
-  if (!m_sPreviousMove.isEmpty()) {
-    QStringList sListPrev;
-    QStringList sListCur;
-    sListPrev = m_sPreviousMove.split(":");
-    sListCur = sMove.split(":");
+// Repeated positions or endless games (e.g. two CPUs moving towers back and
+// forth) end in a tie
+bool Game::checkTie() {
+  if (0 != m_nDrawRepetitions &&
+      m_History.count(m_State.getKey()) >= m_nDrawRepetitions) {
+    qDebug() << "POSITION REPEATED" << m_nDrawRepetitions << "TIMES!";
+    QMessageBox::information(NULL, trUtf8("Information"),
+                             trUtf8("Position repeated %1 times.\n"
+                                    "Game ends in a tie!")
+                             .arg(m_nDrawRepetitions));
+    return true;
+  }
+  if (m_nPlies >= m_nMaxPlies) {
+    qDebug() << "MAXIMUM GAME LENGTH REACHED!";
+    QMessageBox::information(NULL, trUtf8("Information"),
+                             trUtf8("Maximum game length of %1 plies "
+                                    "reached.\nGame ends in a tie!")
+                             .arg(m_nMaxPlies));
+    return true;
+  }
+  return false;
+}
 
-    if (2 == sListPrev.size() && 2 == sListCur.size()) {
-      QString tmp(sListPrev[1]);
-      sListPrev.removeLast();
-      sListPrev << tmp.split("-");
-      tmp = sListCur[1];
-      sListCur.removeLast();
-      sListCur << tmp.split("-");
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
 
-      if (3 == sListPrev.size() && 3 == sListCur.size()) {
-        if (sListPrev[0] == sListCur[2] &&
-            sListPrev[1] == sListCur[1] &&
-            sListPrev[2] == sListCur[0]) {
-          return true;
-        }
-      } else {
-        qDebug() << Q_FUNC_INFO;
-        qWarning() << "Splitting 2 failed:" << m_sPreviousMove << sMove;
-        QMessageBox::warning(NULL, trUtf8("Warning"),
-                             trUtf8("Something went wrong!"));
-        return false;
-      }
-    } else {
-      qDebug() << Q_FUNC_INFO;
-      qWarning() << "Splitting 1 failed:" << m_sPreviousMove << sMove;
-      QMessageBox::warning(NULL, trUtf8("Warning"),
-                           trUtf8("Something went wrong!"));
-      return false;
-    }
+bool Game::isHumanActive() const {
+  if (1 == m_State.getCurrentPlayer()) {
+    return m_pPlayer1->getIsHuman();
   }
-
-  m_sPreviousMove = sMove;
-  return false;
+  return m_pPlayer2->getIsHuman();
 }
 
 // ---------------------------------------------------------------------------
@@ -639,7 +643,7 @@ bool Game::saveGame(const QString &sFile) {
   QJsonArray tower;
   QVariantList vartower;
   QJsonArray jsBoard;
-  QList<QList<QList<quint8> > > board(m_pBoard->getBoard());
+  QList<QList<QList<quint8> > > board(m_State.getBoard());
 
   if (!saveFile.open(QIODevice::WriteOnly)) {
     qWarning() << "Couldn't open save file:" << sFile;
@@ -663,11 +667,11 @@ bool Game::saveGame(const QString &sFile) {
   QJsonObject jsonObj;
   jsonObj["Name1"] = m_pPlayer1->getName();
   jsonObj["Name2"] = m_pPlayer2->getName();
-  jsonObj["Won1"] = m_pPlayer1->getWonTowers();
-  jsonObj["Won2"] = m_pPlayer2->getWonTowers();
-  jsonObj["HumanCpu1"] = m_pPlayer1->getIsHuman() ? "Human" : m_sJsFileP1;
-  jsonObj["HumanCpu2"] = m_pPlayer2->getIsHuman() ? "Human" : m_sJsFileP2;
-  jsonObj["Current"] = m_pPlayer1->getIsActive() ? 1 : 2;
+  jsonObj["Won1"] = m_State.getWonTowers(1);
+  jsonObj["Won2"] = m_State.getWonTowers(2);
+  jsonObj["HumanCpu1"] = m_pPlayer1->getIsHuman() ? "Human" : m_sCpuP1;
+  jsonObj["HumanCpu2"] = m_pPlayer2->getIsHuman() ? "Human" : m_sCpuP2;
+  jsonObj["Current"] = m_State.getCurrentPlayer();
   jsonObj["Board"] = jsBoard;
 
   QJsonDocument jsDoc(jsonObj);
@@ -27,19 +27,26 @@
 #ifndef GAME_H_
 #define GAME_H_
 
+#include <QTimer>
+
 #include "./board.h"
+#include "./clock.h"
+#include "./gamestate.h"
+#include "./history.h"
 #include "./player.h"
-#include "./opponentjs.h"
+#include "./opponent.h"
+#include "./random.h"
 
 class Game : public QObject {
   Q_OBJECT
 
   public:
-    explicit Game(Settings *pSettings, const QStringList &sListFiles);
+    Game(Settings *pSettings, const QStringList &sListFiles,
+         const quint64 nSeed);
     QGraphicsScene* getScene() const;
     QRectF getSceneRect() const;
     bool saveGame(const QString &sFile);
-    void updatePlayers(bool bInitial = false);
+    void updatePlayers();
     bool initCpu();
 
   signals:
@@ -52,42 +59,56 @@ class Game : public QObject {
     void setInteractive(bool bEnabled);
     void highlightActivePlayer(bool bPlayer1,
                                bool bP1Won = false, bool bP2Won = false);
-    void makeMoveCpuP1(QList<QList<QList<quint8> > > board,
-                       quint8 nPossibleMove);
-    void makeMoveCpuP2(QList<QList<QList<quint8> > > board,
-                       quint8 nPossibleMove);
+    void makeMoveCpuP1(const GameState &state);
+    void makeMoveCpuP2(const GameState &state);
+    void moveApplied(const Move &move, const quint8 nPlayer);
+    void cpuError(const QString &sError);
 
   private slots:
     void setStone(QPoint field);
-    void moveTower(QPoint tower, QPoint moveTo, quint8 nStones = 0);
+    void moveTower(QPoint tower, QPoint moveTo);
+    void cpuMove(const Move &move);
     void delayCpu();
-    void caughtScriptError();
+    void caughtScriptError(const QString &sError);
+    void updateClocks();
 
   private:
-    void createCPU1();
-    void createCPU2();
+    Opponent *createCpu(const quint8 nID, const QString &sCpu);
     QJsonObject loadGame(const QString &sFile);
-    void checkPossibleMoves();
-    bool checkPreviousMoveReverted(const QString sMove);
-    void checkTowerWin(QPoint field);
-    void returnStones(QPoint field);
+    bool checkPossibleMoves();
+    bool checkTie();
+    bool isHumanActive() const;
+    QString stonesText(const quint8 nPlayer) const;
+    void makeMove(const Move &move);
+    void applyMove(const Move &move);
+    void checkTowerWin(const QPoint field,
+                       const quint8 nWonP1, const quint8 nWonP2);
 
     Settings *m_pSettings;
     Board *m_pBoard;
-    OpponentJS *m_jsCpuP1;
-    OpponentJS *m_jsCpuP2;
+    Opponent *m_pCpuP1;
+    Opponent *m_pCpuP2;
     Player *m_pPlayer1;
     Player *m_pPlayer2;
-    QString m_sJsFileP1;
-    QString m_sJsFileP2;
+    QString m_sCpuP1;
+    QString m_sCpuP2;
 
     const quint8 m_nMaxTowerHeight;
     const quint8 m_nMaxStones;
     const quint16 m_nGridSize;
     const quint8 m_nNumOfFields;
+    const quint8 m_nDrawRepetitions;
+    const quint16 m_nMaxPlies;
+    GameState m_State;
+    History m_History;
+    quint16 m_nPlies;
+    Clock m_Clock;
+    QTimer m_ClockTimer;  // Updates the display, detects loss on time
 
     bool m_bScriptError;
-    QString m_sPreviousMove;
+    bool m_bCpuInitialized;
+    bool m_bTimeOver;
+    Random m_Random;  // Start player and seeds of the CPUs
 };
 
 #endif  // GAME_H_
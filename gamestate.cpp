@@ -0,0 +1,622 @@
+/**
+ * \file gamestate.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * GUI independent game state and rules (move generation, apply / undo).
+ */
+
+#include <QDebug>
+#include <QStringList>
+#include <QtAlgorithms>
+
+#include "./gamestate.h"
+
+GameState::GameState(const quint8 nNumOfFields, const quint8 nMaxTowerHeight,
+                     const quint8 nMaxStones, const quint8 nWinTowers)
+  : m_nNumOfFields(nNumOfFields),
+    m_nMaxTowerHeight(nMaxTowerHeight),
+    m_nMaxStones(nMaxStones),
+    m_nWinTowers(nWinTowers),
+    m_pTables(MoveTables::instance(nNumOfFields)) {
+  // Packed position: one bit per field, towers stay below the max. height
+  Q_ASSERT(nNumOfFields * nNumOfFields <= Position::MaxFields);
+  Q_ASSERT(nMaxTowerHeight <= Position::MaxLevels + 1);
+  m_Pos.setStonesLeft(1, m_nMaxStones);
+  m_Pos.setStonesLeft(2, m_nMaxStones);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void GameState::setupBoard(const QList<QList<QList<quint8> > > &board) {
+  const quint8 nPlayer(m_Pos.currentPlayer());
+  const quint8 nWonP1(m_Pos.wonTowers(1));
+  const quint8 nWonP2(m_Pos.wonTowers(2));
+  quint8 nStonesLeft[2] = {m_nMaxStones, m_nMaxStones};
+
+  m_Pos = Position();
+  for (int x = 0; x < m_nNumOfFields && x < board.size(); x++) {
+    for (int y = 0; y < m_nNumOfFields && y < board[x].size(); y++) {
+      quint8 nHeight(0);
+      quint8 nColors(0);
+      foreach (quint8 stone, board[x][y]) {
+        if ((1 != stone && 2 != stone) || nHeight >= Position::MaxLevels) {
+          qWarning() << "Invalid stone in board setup:" << stone;
+          continue;
+        }
+        if (2 == stone) {
+          nColors |= (1 << nHeight);
+        }
+        nHeight++;
+        nStonesLeft[stone - 1]--;
+      }
+      m_Pos.setTower(this->fieldIndex(QPoint(x, y)), nHeight, nColors);
+    }
+  }
+
+  m_Pos.setStonesLeft(1, nStonesLeft[0]);
+  m_Pos.setStonesLeft(2, nStonesLeft[1]);
+  m_Pos.setWonTowers(1, nWonP1);
+  m_Pos.setWonTowers(2, nWonP2);
+  m_Pos.setCurrentPlayer(nPlayer);
+}
+
+// ---------------------------------------------------------------------------
+
+QList<QList<QList<quint8> > > GameState::getBoard() const {
+  QList<QList<QList<quint8> > > board;
+  for (int x = 0; x < m_nNumOfFields; x++) {
+    QList<QList<quint8> > line;
+    for (int y = 0; y < m_nNumOfFields; y++) {
+      line.append(this->getField(QPoint(x, y)));
+    }
+    board.append(line);
+  }
+  return board;
+}
+
+// ---------------------------------------------------------------------------
+
+QList<quint8> GameState::getField(const QPoint field) const {
+  QList<quint8> tower;
+  const qint8 nIndex(this->fieldIndex(field));
+  if (nIndex < 0) {
+    return tower;
+  }
+  for (int i = 0; i < m_Pos.height(nIndex); i++) {
+    tower.append(m_Pos.stone(nIndex, i));
+  }
+  return tower;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint8 GameState::getNumOfFields() const {
+  return m_nNumOfFields;
+}
+quint8 GameState::getMaxTowerHeight() const {
+  return m_nMaxTowerHeight;
+}
+quint8 GameState::getMaxStones() const {
+  return m_nMaxStones;
+}
+quint8 GameState::getWinTowers() const {
+  return m_nWinTowers;
+}
+void GameState::setWinTowers(const quint8 nWinTowers) {
+  m_nWinTowers = nWinTowers;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+qint8 GameState::fieldIndex(const QPoint field) const {
+  if (field.x() < 0 || field.y() < 0 ||
+      field.x() >= m_nNumOfFields || field.y() >= m_nNumOfFields) {
+    return -1;
+  }
+  return field.y() * m_nNumOfFields + field.x();
+}
+
+QPoint GameState::fieldPoint(const qint8 nIndex) const {
+  if (nIndex < 0) {
+    return QPoint(-1, -1);
+  }
+  return QPoint(nIndex % m_nNumOfFields, nIndex / m_nNumOfFields);
+}
+
+quint8 GameState::getHeight(const qint8 nIndex) const {
+  return m_Pos.height(nIndex);
+}
+
+quint8 GameState::getStone(const qint8 nIndex, const quint8 nLevel) const {
+  return m_Pos.stone(nIndex, nLevel);
+}
+
+quint8 GameState::getTopStone(const qint8 nIndex) const {
+  return m_Pos.topStone(nIndex);
+}
+
+const Position &GameState::getPosition() const {
+  return m_Pos;
+}
+
+quint64 GameState::getKey() const {
+  return m_Pos.key();
+}
+
+// Key of the canonical one of the eight symmetric positions (smallest key
+// of the board part). pSymmetry receives the symmetry, which maps this
+// position onto the canonical one.
+quint64 GameState::getCanonicalKey(quint8 *pSymmetry) const {
+  quint64 nKeys[MoveTables::Symmetries] = {0};
+  quint32 nTowers(m_Pos.occupied());
+  while (0 != nTowers) {
+    const qint8 nField(qCountTrailingZeroBits(nTowers));
+    nTowers &= nTowers - 1;
+    const quint8 nHeight(m_Pos.height(nField));
+    const quint8 nColors(m_Pos.colors(nField));
+    for (int nSym = 0; nSym < MoveTables::Symmetries; nSym++) {
+      nKeys[nSym] ^= Zobrist::tower(m_pTables->transform(nSym, nField),
+                                    nHeight, nColors);
+    }
+  }
+  const Move prev(m_Pos.previousMove());
+  if (prev.nFrom >= 0 && prev.nTo >= 0) {
+    for (int nSym = 0; nSym < MoveTables::Symmetries; nSym++) {
+      nKeys[nSym] ^= Zobrist::previousMove(
+                       m_pTables->transform(nSym, prev.nFrom),
+                       m_pTables->transform(nSym, prev.nTo), prev.nStones);
+    }
+  }
+
+  // Symmetry 0 is the identity, the rest of the key is not affected
+  const quint64 nRest(m_Pos.key() ^ nKeys[0]);
+  quint8 nBest(0);
+  for (int nSym = 1; nSym < MoveTables::Symmetries; nSym++) {
+    if (nKeys[nSym] < nKeys[nBest]) {
+      nBest = nSym;
+    }
+  }
+  if (NULL != pSymmetry) {
+    *pSymmetry = nBest;
+  }
+  return nKeys[nBest] ^ nRest;
+}
+
+Move GameState::transformMove(const Move &move,
+                              const quint8 nSymmetry) const {
+  if (!move.isValid()) {
+    return move;
+  }
+  return Move(move.isSetStone() ? move.nFrom
+                                : m_pTables->transform(nSymmetry, move.nFrom),
+              m_pTables->transform(nSymmetry, move.nTo), move.nStones);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint8 GameState::getCurrentPlayer() const {
+  return m_Pos.currentPlayer();
+}
+
+void GameState::setCurrentPlayer(const quint8 nPlayer) {
+  m_Pos.setCurrentPlayer((2 == nPlayer) ? 2 : 1);
+}
+
+void GameState::passTurn() {
+  m_Pos.setCurrentPlayer(3 - m_Pos.currentPlayer());
+}
+
+quint8 GameState::getStonesLeft(const quint8 nPlayer) const {
+  return m_Pos.stonesLeft(nPlayer);
+}
+
+quint8 GameState::getWonTowers(const quint8 nPlayer) const {
+  return m_Pos.wonTowers(nPlayer);
+}
+
+void GameState::setWonTowers(const quint8 nPlayer, const quint8 nWonTowers) {
+  m_Pos.setWonTowers(nPlayer, nWonTowers);
+}
+
+quint8 GameState::getWinner() const {
+  if (m_Pos.wonTowers(1) >= m_nWinTowers) {
+    return 1;
+  } else if (m_Pos.wonTowers(2) >= m_nWinTowers) {
+    return 2;
+  }
+  return 0;
+}
+
+Move GameState::getPreviousMove() const {
+  return m_Pos.previousMove();
+}
+
+void GameState::setPreviousMove(const Move &move) {
+  m_Pos.setPreviousMove(move);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint32 GameState::getSources(const qint8 nTo) const {
+  // The height of the target tower defines the exact distance
+  return m_pTables->sources(nTo, m_Pos.height(nTo), m_Pos.occupied());
+}
+
+// ---------------------------------------------------------------------------
+
+QList<QPoint> GameState::checkNeighbourhood(const QPoint field) const {
+  QList<QPoint> neighbours;
+  const qint8 nTo(this->fieldIndex(field));
+  if (nTo < 0) {
+    return neighbours;
+  }
+
+  quint32 nSources(this->getSources(nTo));
+  while (0 != nSources) {
+    const qint8 nFrom(qCountTrailingZeroBits(nSources));
+    nSources &= nSources - 1;
+    neighbours.append(this->fieldPoint(nFrom));
+  }
+  return neighbours;
+}
+
+// ---------------------------------------------------------------------------
+
+quint8 GameState::findPossibleMoves(const quint8 nPlayer) const {
+  // Return: 0 = no moves
+  // 1 = stone can be set
+  // 2 = tower can be moved
+  // 3 = stone can be set and tower can be moved
+  quint8 nRet(0);
+  const int nFields(m_nNumOfFields * m_nNumOfFields);
+  const quint32 nAll((nFields < 32) ? ((1u << nFields) - 1) : 0xFFFFFFFFu);
+
+  if (this->getStonesLeft(nPlayer) > 0 && nAll != m_Pos.occupied()) {
+    nRet |= 1;
+  }
+
+  // Reverting the previous move is not allowed (as in generateMoves()), a
+  // single stone moved back is the only move of its tower then
+  const Move previous(m_Pos.previousMove());
+  quint32 nTowers(m_Pos.occupied());
+  while (0 != nTowers) {
+    const qint8 nTo(qCountTrailingZeroBits(nTowers));
+    nTowers &= nTowers - 1;
+    quint32 nSources(this->getSources(nTo));
+    if (nTo == previous.nFrom && 1 == previous.nStones &&
+        1 == m_Pos.height(previous.nTo)) {
+      nSources &= ~(1u << previous.nTo);
+    }
+    if (0 != nSources) {
+      nRet |= 2;
+      break;
+    }
+  }
+  return nRet;
+}
+
+// ---------------------------------------------------------------------------
+
+void GameState::generateMoves(QVector<Move> *pMoves) const {
+  pMoves->clear();
+  const int nFields(m_nNumOfFields * m_nNumOfFields);
+  const bool bStonesLeft(m_Pos.stonesLeft(m_Pos.currentPlayer()) > 0);
+  const Move previous(m_Pos.previousMove());
+
+  for (qint8 nTo = 0; nTo < nFields; nTo++) {
+    if (!m_Pos.isOccupied(nTo)) {
+      if (bStonesLeft) {
+        pMoves->append(Move(-1, nTo, 1));
+      }
+      continue;
+    }
+
+    quint32 nSources(this->getSources(nTo));
+    while (0 != nSources) {
+      const qint8 nFrom(qCountTrailingZeroBits(nSources));
+      nSources &= nSources - 1;
+      const quint8 nHeight(m_Pos.height(nFrom));
+      for (quint8 n = 1; n <= nHeight; n++) {
+        if (previous != Move(nTo, nFrom, n)) {
+          pMoves->append(Move(nFrom, nTo, n));
+        }
+      }
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+GameState::MoveResult GameState::checkMove(const Move &move) const {
+  const int nFields(m_nNumOfFields * m_nNumOfFields);
+  if (move.nTo < 0 || move.nTo >= nFields || move.nFrom >= nFields) {
+    return InvalidField;
+  }
+
+  if (move.isSetStone()) {
+    if (m_Pos.isOccupied(move.nTo)) {
+      return FieldNotEmpty;
+    }
+    if (0 == m_Pos.stonesLeft(m_Pos.currentPlayer())) {
+      return NoStonesLeft;
+    }
+    return MoveOk;
+  }
+
+  if (!m_Pos.isOccupied(move.nFrom)) {
+    return EmptyTower;
+  }
+  if (0 == move.nStones || move.nStones > m_Pos.height(move.nFrom)) {
+    return TooManyStones;
+  }
+  if (m_Pos.previousMove() == Move(move.nTo, move.nFrom, move.nStones)) {
+    return RevertsPreviousMove;
+  }
+  if (0 == ((this->getSources(move.nTo) >> move.nFrom) & 1)) {
+    return NotInReach;
+  }
+  return MoveOk;
+}
+
+// ---------------------------------------------------------------------------
+
+void GameState::applyMove(const Move &move, Undo *pUndo) {
+  if (NULL != pUndo) {
+    pUndo->position = m_Pos;
+  }
+
+  const quint8 nPlayer(m_Pos.currentPlayer());
+  quint8 nHeight;
+  quint8 nColors;
+
+  if (move.isSetStone()) {
+    nHeight = 1;
+    nColors = (2 == nPlayer) ? 1 : 0;
+    m_Pos.setStonesLeft(nPlayer, m_Pos.stonesLeft(nPlayer) - 1);
+    m_Pos.setPreviousMove(Move());
+  } else {
+    const quint8 nHeightFrom(m_Pos.height(move.nFrom));
+    const quint8 nColorsFrom(m_Pos.colors(move.nFrom));
+    const quint8 nRemaining(nHeightFrom - move.nStones);
+    nHeight = m_Pos.height(move.nTo);
+    // Moved stones keep their order and are placed on top of the target
+    nColors = m_Pos.colors(move.nTo) | ((nColorsFrom >> nRemaining) << nHeight);
+    nHeight += move.nStones;
+    m_Pos.setTower(move.nFrom, nRemaining, nColorsFrom);
+    m_Pos.setPreviousMove(move);
+  }
+
+  // Tower conquered: top stone wins, all stones return to their owners
+  if (nHeight >= m_nMaxTowerHeight) {
+    const quint8 nWinner(((nColors >> (nHeight - 1)) & 1) ? 2 : 1);
+    quint8 nStonesP2(0);
+    for (int i = 0; i < nHeight; i++) {
+      nStonesP2 += (nColors >> i) & 1;
+    }
+    m_Pos.setStonesLeft(1, m_Pos.stonesLeft(1) + nHeight - nStonesP2);
+    m_Pos.setStonesLeft(2, m_Pos.stonesLeft(2) + nStonesP2);
+    m_Pos.setWonTowers(nWinner, m_Pos.wonTowers(nWinner) + 1);
+    nHeight = 0;
+    nColors = 0;
+  }
+  m_Pos.setTower(move.nTo, nHeight, nColors);
+
+  m_Pos.setCurrentPlayer(3 - nPlayer);
+}
+
+// ---------------------------------------------------------------------------
+
+void GameState::undoMove(const Move &move, const Undo &undo) {
+  Q_UNUSED(move);
+  // Packed positions are cheap enough to be restored as a whole
+  m_Pos = undo.position;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+QString GameState::moveToString(const Move &move) const {
+  // E.g. "C4:3-D3" = move 3 stones from C4 to D3 (ASCII 65 = A)
+  const QPoint to(this->fieldPoint(move.nTo));
+  const QString sTo(static_cast<char>(to.x() + 65) +
+                    QString::number(to.y() + 1));
+  if (move.isSetStone()) {
+    return sTo;
+  }
+  const QPoint from(this->fieldPoint(move.nFrom));
+  return static_cast<char>(from.x() + 65) + QString::number(from.y() + 1) +
+      ":" + QString::number(move.nStones) + "-" + sTo;
+}
+
+// ---------------------------------------------------------------------------
+
+// Inverse of moveToString(), returns an invalid move on syntax errors
+Move GameState::stringToMove(const QString &sMove) const {
+  const QString sUpper(sMove.trimmed().toUpper());
+  const int nColon(sUpper.indexOf(':'));
+  if (-1 == nColon) {
+    const qint8 nTo(this->stringToField(sUpper));
+    return (nTo < 0) ? Move() : Move(-1, nTo, 1);
+  }
+
+  const int nDash(sUpper.indexOf('-', nColon));
+  bool bOk(false);
+  const int nStones(sUpper.mid(nColon + 1, nDash - nColon - 1).toInt(&bOk));
+  const qint8 nFrom(this->stringToField(sUpper.left(nColon)));
+  const qint8 nTo(this->stringToField(sUpper.mid(nDash + 1)));
+  if (-1 == nDash || !bOk || nStones < 1 || nStones > Position::MaxLevels ||
+      nFrom < 0 || nTo < 0) {
+    return Move();
+  }
+  return Move(nFrom, nTo, nStones);
+}
+
+qint8 GameState::stringToField(const QString &sField) const {
+  if (sField.size() < 2) {
+    return -1;
+  }
+  bool bOk(false);
+  const int nY(sField.mid(1).toInt(&bOk) - 1);
+  if (!bOk) {
+    return -1;
+  }
+  return this->fieldIndex(QPoint(sField.at(0).toLatin1() - 65, nY));
+}
+
+// ---------------------------------------------------------------------------
+
+// Position as text, e.g. for the command line: rows (y = 0 first)
+// separated by "/", fields by ",", towers from bottom to top ("-" = empty),
+// followed by the player to move and the previous move (if any).
+// E.g. "-,-,-,-,-/-,12,-,-,-/-,-,1,-,-/-,-,-,-,-/-,-,-,-,- 2 C3:1-B2"
+QString GameState::toString() const {
+  QStringList sListRows;
+  for (int y = 0; y < m_nNumOfFields; y++) {
+    QStringList sListLine;
+    for (int x = 0; x < m_nNumOfFields; x++) {
+      QString sTower;
+      foreach (quint8 stone, this->getField(QPoint(x, y))) {
+        sTower += QString::number(stone);
+      }
+      sListLine << (sTower.isEmpty() ? QString("-") : sTower);
+    }
+    sListRows << sListLine.join(",");
+  }
+
+  QString sPosition(sListRows.join("/") + " " +
+                    QString::number(m_Pos.currentPlayer()));
+  if (m_Pos.previousMove().isValid()) {
+    sPosition += " " + this->moveToString(m_Pos.previousMove());
+  }
+  return sPosition;
+}
+
+bool GameState::setupFromString(const QString &sPosition) {
+  const QStringList sListParts(sPosition.simplified().split(' '));
+  const QStringList sListRows(sListParts[0].split('/'));
+  if (sListParts.size() > 3 || m_nNumOfFields != sListRows.size()) {
+    return false;
+  }
+
+  QList<QList<QList<quint8> > > board;
+  for (int x = 0; x < m_nNumOfFields; x++) {
+    board.append(QList<QList<quint8> >());
+    for (int y = 0; y < m_nNumOfFields; y++) {
+      board[x].append(QList<quint8>());
+    }
+  }
+
+  quint8 nStones[2] = {0, 0};
+  for (int y = 0; y < m_nNumOfFields; y++) {
+    const QStringList sListLine(sListRows[y].split(','));
+    if (m_nNumOfFields != sListLine.size()) {
+      return false;
+    }
+    for (int x = 0; x < m_nNumOfFields; x++) {
+      if ("-" == sListLine[x]) {
+        continue;
+      }
+      // Towers of max. height would have been conquered already
+      if (sListLine[x].isEmpty() ||
+          sListLine[x].size() >= m_nMaxTowerHeight) {
+        return false;
+      }
+      for (int i = 0; i < sListLine[x].size(); i++) {
+        const quint8 nStone(sListLine[x].at(i).toLatin1() - 48);
+        if (1 != nStone && 2 != nStone) {
+          return false;
+        }
+        board[x][y].append(nStone);
+        nStones[nStone - 1]++;
+      }
+    }
+  }
+  if (nStones[0] > m_nMaxStones || nStones[1] > m_nMaxStones) {
+    return false;
+  }
+
+  quint8 nPlayer(1);
+  if (sListParts.size() > 1) {
+    if ("1" != sListParts[1] && "2" != sListParts[1]) {
+      return false;
+    }
+    nPlayer = sListParts[1].toUInt();
+  }
+  Move previous;
+  if (sListParts.size() > 2) {
+    previous = this->stringToMove(sListParts[2]);
+    if (!previous.isValid() || previous.isSetStone()) {
+      return false;
+    }
+  }
+
+  this->setupBoard(board);
+  this->setCurrentPlayer(nPlayer);
+  m_Pos.setPreviousMove(previous);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+QString GameState::resultToString(const MoveResult result) {
+  switch (result) {
+    case MoveOk:
+      return "Ok";
+    case InvalidField:
+      return "Field out of board";
+    case FieldNotEmpty:
+      return "Stone can only be set on a free field";
+    case NoStonesLeft:
+      return "No stones left";
+    case EmptyTower:
+      return "Selected tower is empty";
+    case TooManyStones:
+      return "Invalid number of stones to move";
+    case NotInReach:
+      return "Tower is not in the neighbourhood of the target tower";
+    case RevertsPreviousMove:
+      return "Move reverts previous move";
+  }
+  return "Unknown";
+}
+
+// ---------------------------------------------------------------------------
+
+void GameState::printDebugFields() const {
+  qDebug() << "BOARD:";
+  for (int y = 0; y < m_nNumOfFields; y++) {
+    QStringList sListLine;
+    for (int x = 0; x < m_nNumOfFields; x++) {
+      QString sTower;
+      foreach (quint8 stone, this->getField(QPoint(x, y))) {
+        sTower += QString::number(stone);
+      }
+      sListLine << "(" + sTower + ")";
+    }
+    qDebug() << qPrintable(sListLine.join(" "));
+  }
+}
@@ -0,0 +1,126 @@
+/**
+ * \file gamestate.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the GUI independent game state / rules.
+ */
+
+#ifndef GAMESTATE_H_
+#define GAMESTATE_H_
+
+#include <QList>
+#include <QMetaType>
+#include <QPoint>
+#include <QVector>
+
+#include "./movetables.h"
+#include "./position.h"
+
+/**
+ * \class GameState
+ * \brief Complete game position and rules, without any GUI dependency.
+ *
+ * Board and Game only observe this state; bots and analysis tools can
+ * apply / undo moves on a copy without creating a scene.
+ */
+class GameState {
+  public:
+    enum MoveResult {
+      MoveOk = 0,
+      InvalidField,
+      FieldNotEmpty,
+      NoStonesLeft,
+      EmptyTower,
+      TooManyStones,
+      NotInReach,
+      RevertsPreviousMove
+    };
+
+    /**
+     * \struct Undo
+     * \brief Information needed to take back a move with undoMove().
+     */
+    struct Undo {
+      Position position;
+    };
+
+    GameState(const quint8 nNumOfFields = 5, const quint8 nMaxTowerHeight = 5,
+              const quint8 nMaxStones = 20, const quint8 nWinTowers = 1);
+
+    void setupBoard(const QList<QList<QList<quint8> > > &board);
+    QList<QList<QList<quint8> > > getBoard() const;
+    QList<quint8> getField(const QPoint field) const;
+
+    quint8 getNumOfFields() const;
+    quint8 getMaxTowerHeight() const;
+    quint8 getMaxStones() const;
+    quint8 getWinTowers() const;
+    void setWinTowers(const quint8 nWinTowers);
+
+    qint8 fieldIndex(const QPoint field) const;
+    QPoint fieldPoint(const qint8 nIndex) const;
+    quint8 getHeight(const qint8 nIndex) const;
+    quint8 getStone(const qint8 nIndex, const quint8 nLevel) const;
+    quint8 getTopStone(const qint8 nIndex) const;
+    const Position &getPosition() const;
+    quint64 getKey() const;
+    quint64 getCanonicalKey(quint8 *pSymmetry = NULL) const;
+    Move transformMove(const Move &move, const quint8 nSymmetry) const;
+
+    quint8 getCurrentPlayer() const;
+    void setCurrentPlayer(const quint8 nPlayer);
+    void passTurn();
+    quint8 getStonesLeft(const quint8 nPlayer) const;
+    quint8 getWonTowers(const quint8 nPlayer) const;
+    void setWonTowers(const quint8 nPlayer, const quint8 nWonTowers);
+    quint8 getWinner() const;
+    Move getPreviousMove() const;
+    void setPreviousMove(const Move &move);
+
+    QList<QPoint> checkNeighbourhood(const QPoint field) const;
+    quint32 getSources(const qint8 nTo) const;
+    quint8 findPossibleMoves(const quint8 nPlayer) const;
+    void generateMoves(QVector<Move> *pMoves) const;
+    MoveResult checkMove(const Move &move) const;
+    void applyMove(const Move &move, Undo *pUndo = NULL);
+    void undoMove(const Move &move, const Undo &undo);
+
+    QString moveToString(const Move &move) const;
+    Move stringToMove(const QString &sMove) const;
+    QString toString() const;
+    bool setupFromString(const QString &sPosition);
+    static QString resultToString(const MoveResult result);
+    void printDebugFields() const;
+
+  private:
+    qint8 stringToField(const QString &sField) const;
+
+    quint8 m_nNumOfFields;
+    quint8 m_nMaxTowerHeight;
+    quint8 m_nMaxStones;
+    quint8 m_nWinTowers;
+    const MoveTables *m_pTables;
+    Position m_Pos;
+};
+Q_DECLARE_METATYPE(GameState)
+
+#endif  // GAMESTATE_H_
@@ -0,0 +1,46 @@
+/**
+ * \file history.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Position history of a game, detects repeated positions.
+ */
+
+#include "./history.h"
+
+void History::clear() {
+  m_Keys.clear();
+  m_Counts.clear();
+}
+
+void History::push(const quint64 nKey) {
+  m_Keys.append(nKey);
+  m_Counts[nKey]++;
+}
+
+void History::pop() {
+  Q_ASSERT(!m_Keys.isEmpty());
+  QHash<quint64, int>::iterator it(m_Counts.find(m_Keys.last()));
+  if (0 == --it.value()) {
+    m_Counts.erase(it);
+  }
+  m_Keys.removeLast();
+}
@@ -0,0 +1,62 @@
+/**
+ * \file history.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the position history of a game.
+ */
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include <QHash>
+#include <QMetaType>
+#include <QVector>
+
+/**
+ * \class History
+ * \brief Zobrist keys of all positions of a game, in the order played.
+ *
+ * The number of occurrences of each key is kept in a hash, so checking a
+ * position for a repetition is O(1). Used to end games by repetition and
+ * to cut cycles in the search.
+ */
+class History {
+  public:
+    void clear();
+    void push(const quint64 nKey);
+    void pop();
+    bool isEmpty() const { return m_Keys.isEmpty(); }
+    int size() const { return m_Keys.size(); }
+    quint64 last() const { return m_Keys.last(); }
+
+    bool contains(const quint64 nKey) const {
+      return m_Counts.contains(nKey);
+    }
+    int count(const quint64 nKey) const { return m_Counts.value(nKey, 0); }
+
+  private:
+    QVector<quint64> m_Keys;  // Order of the positions, for pop() / last()
+    QHash<quint64, int> m_Counts;
+};
+Q_DECLARE_METATYPE(History)
+
+#endif  // HISTORY_H_
@@ -31,9 +31,18 @@
  */
 
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QTextStream>
+#include <QThread>
 
+#include "./arena.h"
+#include "./bookbuilder.h"
+#include "./perft.h"
+#include "./random.h"
+#include "./retrograde.h"
+#include "./scriptrunner.h"
 #include "./stackandconquer.h"
+#include "./tournament.h"
 
 QFile logfile;
 QTextStream out(&logfile);
@@ -46,7 +55,45 @@ void LoggingHandler(QtMsgType type,
                     const QMessageLogContext &context,
                     const QString &sMsg);
 
+QString getSharePath();
+QDir getUserDataDir();
+int runPerft(const QStringList &sListArgs);
+bool readCpuOptions(const QStringList &sListArgs, QStringList *pListArgs,
+                    Opponent::Options *pOptions, int *pWinTowers);
+bool readBookOptions(QStringList *pListArgs, QString *psBookOut,
+                     int *pnBookPlies);
+bool writeBook(const BookBuilder &book, const QString &sFile,
+               QTextStream *pOut);
+int runArena(const QStringList &sListArgs);
+int runTournament(const QStringList &sListArgs);
+int runTablebaseGen(const QStringList &sListArgs);
+void ArenaLoggingHandler(QtMsgType type,
+                         const QMessageLogContext &context,
+                         const QString &sMsg);
+
 int main(int argc, char *argv[]) {
+  // Move generator test and CPU vs. CPU games / tournaments run without
+  // any window
+  for (int i = 1; i < argc; i++) {
+    if (QString("--perft") == argv[i]) {
+      QCoreApplication app(argc, argv);
+      return runPerft(app.arguments().mid(i + 1));
+    } else if (QString("--arena") == argv[i]) {
+      QCoreApplication app(argc, argv);
+      app.setApplicationName(APP_NAME);
+      app.setApplicationVersion(APP_VERSION);
+      return runArena(app.arguments().mid(i + 1));
+    } else if (QString("--tournament") == argv[i]) {
+      QCoreApplication app(argc, argv);
+      app.setApplicationName(APP_NAME);
+      app.setApplicationVersion(APP_VERSION);
+      return runTournament(app.arguments().mid(i + 1));
+    } else if (QString("--tablebase-gen") == argv[i]) {
+      QCoreApplication app(argc, argv);
+      return runTablebaseGen(app.arguments().mid(i + 1));
+    }
+  }
+
   QApplication app(argc, argv);
   app.setApplicationName(APP_NAME);
   app.setApplicationVersion(APP_VERSION);
@@ -58,24 +105,46 @@ int main(int argc, char *argv[]) {
     exit(0);
   }
 
+  const QString sSharePath(getSharePath());
+  const QDir userDataDir(getUserDataDir());
+
+  const QString sDebugFile("debug.log");
+  setupLogger(userDataDir.absolutePath() + "/" + sDebugFile,
+              app.applicationName(), app.applicationVersion());
+
+  StackAndConquer myStackAndConquer(sSharePath, userDataDir);
+  myStackAndConquer.show();
+  int nRet = app.exec();
+
+  logfile.close();
+  return nRet;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+QString getSharePath() {
   // Default share data path (Windows and debugging)
-  QString sSharePath = app.applicationDirPath();
+  QString sSharePath = QCoreApplication::applicationDirPath();
   // Standard installation path (Linux)
-  QDir tmpDir(app.applicationDirPath() + "/../share/"
-              + app.applicationName().toLower());
-  if (!app.arguments().contains("--debug") && tmpDir.exists()) {
-    sSharePath = app.applicationDirPath() + "/../share/"
-                 + app.applicationName().toLower();
+  QDir tmpDir(QCoreApplication::applicationDirPath() + "/../share/"
+              + QCoreApplication::applicationName().toLower());
+  if (!QCoreApplication::arguments().contains("--debug") && tmpDir.exists()) {
+    sSharePath = QCoreApplication::applicationDirPath() + "/../share/"
+                 + QCoreApplication::applicationName().toLower();
   }
 #if defined(Q_OS_OSX)
-  sSharePath = app.applicationDirPath() + "/../Resources/";
+  sSharePath = QCoreApplication::applicationDirPath() + "/../Resources/";
 #endif
+  return sSharePath;
+}
 
+QDir getUserDataDir() {
   QStringList sListPaths = QStandardPaths::standardLocations(
                              QStandardPaths::DataLocation);
   if (sListPaths.isEmpty()) {
     qCritical() << "Error while getting data standard path.";
-    sListPaths << app.applicationDirPath();
+    sListPaths << QCoreApplication::applicationDirPath();
   }
   const QDir userDataDir(sListPaths[0].toLower());
 
@@ -83,17 +152,7 @@ int main(int argc, char *argv[]) {
   if (!userDataDir.exists()) {
     userDataDir.mkpath(userDataDir.absolutePath());
   }
-
-  const QString sDebugFile("debug.log");
-  setupLogger(userDataDir.absolutePath() + "/" + sDebugFile,
-              app.applicationName(), app.applicationVersion());
-
-  StackAndConquer myStackAndConquer(sSharePath, userDataDir);
-  myStackAndConquer.show();
-  int nRet = app.exec();
-
-  logfile.close();
-  return nRet;
+  return userDataDir;
 }
 
 // ----------------------------------------------------------------------------
@@ -158,3 +217,333 @@ void LoggingHandler(QtMsgType type,
       break;
   }
 }
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// --perft <depth> [position], position as in GameState::toString()
+int runPerft(const QStringList &sListArgs) {
+  QTextStream outStd(stdout);
+  bool bOk(false);
+  const int nDepth(sListArgs.isEmpty() ? 0 : sListArgs[0].toInt(&bOk));
+  if (!bOk || nDepth < 1 || nDepth > Perft::MaxDepth) {
+    outStd << "Usage: --perft <depth 1-" << Perft::MaxDepth
+           << "> [position]" << endl;
+    return -1;
+  }
+
+  // Same board as a new game (5x5 fields, height 5, 20 stones, 1 tower)
+  GameState state(5, 5, 20, 1);
+  const QString sPosition(sListArgs.mid(1).join(" "));
+  if (!sPosition.trimmed().isEmpty() && !state.setupFromString(sPosition)) {
+    outStd << "Invalid position: " << sPosition << endl;
+    return -1;
+  }
+
+  outStd << "Position: " << state.toString() << endl << endl;
+  Perft perft(state);
+  perft.divide(nDepth, &outStd);
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// --tablebase-gen <file> [games] [plies] [--win n] [--seed n]: retrograde
+// analysis of the endgames of random games, see Retrograde
+int runTablebaseGen(const QStringList &sListArgs) {
+  QTextStream outStd(stdout);
+  QStringList sListRest;
+  Opponent::Options options;
+  options.nSeed = Random::timeSeed();
+  int nWinTowers(1);
+  bool bOk(readCpuOptions(sListArgs, &sListRest, &options, &nWinTowers));
+  int nGames(20);
+  int nPlies(3);
+  if (bOk && sListRest.size() > 1) {
+    nGames = sListRest[1].toInt(&bOk);
+  }
+  if (bOk && sListRest.size() > 2) {
+    nPlies = sListRest[2].toInt(&bOk);
+  }
+
+  if (!bOk || sListRest.isEmpty() || sListRest.size() > 3 || nGames < 1 ||
+      nPlies < 1 || nPlies > Retrograde::MaxDepth) {
+    outStd << "Usage: --tablebase-gen <file> [games] [plies 1-"
+           << Retrograde::MaxDepth << "] [--win n] [--seed n]" << endl;
+    return -1;
+  }
+
+  // Same board as a new game (5x5 fields, height 5, 20 stones)
+  qInstallMessageHandler(ArenaLoggingHandler);
+  QElapsedTimer timer;
+  timer.start();
+  Retrograde retrograde(GameState(5, 5, 20, nWinTowers), nPlies,
+                        options.nSeed);
+  outStd << "Seed: " << options.nSeed << endl;
+  retrograde.addEndgames(nGames);
+  retrograde.expand();
+  retrograde.solve();
+  outStd << "Roots: " << retrograde.getRoots() << ", nodes: "
+         << retrograde.getNodes() << endl
+         << "Solved: " << retrograde.getSolved(Tablebase::Win) << " won, "
+         << retrograde.getSolved(Tablebase::Loss) << " lost, "
+         << retrograde.getSolved(Tablebase::Draw) << " draw" << endl;
+  if (!retrograde.write(sListRest[0])) {
+    outStd << "Couldn't write " << sListRest[0] << endl;
+    return -1;
+  }
+  outStd << "Time: " << timer.elapsed() << " ms" << endl;
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+// Reads the engine / script options (name / value pairs) and returns all
+// other arguments in pListArgs
+bool readCpuOptions(const QStringList &sListArgs, QStringList *pListArgs,
+                    Opponent::Options *pOptions, int *pWinTowers) {
+  bool bOk(true);
+  for (int i = 0; i < sListArgs.size() && bOk; i++) {
+    const QString sArg(sListArgs[i]);
+    if ("--script-gc" == sArg) {
+      pOptions->bScriptGc = true;
+      continue;
+    }
+    if ("--depth" != sArg && "--time" != sArg && "--threads" != sArg &&
+        "--script-time" != sArg && "--script-memory" != sArg &&
+        "--win" != sArg && "--seed" != sArg && "--tablebase" != sArg &&
+        "--book" != sArg && "--draw-repetitions" != sArg &&
+        "--max-plies" != sArg && "--clock" != sArg &&
+        "--clock-inc" != sArg) {
+      *pListArgs << sArg;
+      continue;
+    }
+
+    i++;
+    if ("--tablebase" == sArg || "--book" == sArg) {
+      bOk = i < sListArgs.size();
+      if (bOk) {
+        if ("--book" == sArg) {
+          pOptions->sBook = sListArgs[i];
+        } else {
+          pOptions->sTablebase = sListArgs[i];
+        }
+      }
+      continue;
+    }
+    if ("--seed" == sArg) {
+      if (i < sListArgs.size()) {
+        pOptions->nSeed = sListArgs[i].toULongLong(&bOk);
+      } else {
+        bOk = false;
+      }
+      continue;
+    }
+    const int nValue(i < sListArgs.size() ? sListArgs[i].toInt(&bOk) : 0);
+    if (i >= sListArgs.size()) {
+      bOk = false;
+    } else if ("--depth" == sArg) {
+      pOptions->nSearchDepth = qBound(1, nValue, 20);
+    } else if ("--time" == sArg) {
+      pOptions->nSearchTime = qBound(1, nValue, 60000);
+    } else if ("--threads" == sArg) {
+      pOptions->nThreads = qBound(1, nValue, 64);
+    } else if ("--script-time" == sArg) {
+      pOptions->nScriptTimeLimit = qBound(100, nValue, 600000);
+    } else if ("--script-memory" == sArg) {
+      pOptions->nScriptMemoryMB = qBound(0, nValue, 65536);
+    } else if ("--draw-repetitions" == sArg) {
+      pOptions->nDrawRepetitions = (nValue <= 0) ? 0 : qBound(2, nValue, 255);
+    } else if ("--max-plies" == sArg) {
+      pOptions->nMaxPlies = qBound(1, nValue, 65535);
+    } else if ("--clock" == sArg) {
+      pOptions->nClockTime = qBound(0, nValue, 36000000);
+    } else if ("--clock-inc" == sArg) {
+      pOptions->nClockIncrement = qBound(0, nValue, 600000);
+    } else {
+      *pWinTowers = qBound(1, nValue, 10);
+    }
+  }
+  if (0 != pOptions->nScriptMemoryMB && !ScriptRunner::canMeasureHeap()) {
+    qWarning() << "--script-memory has no effect, this build can't measure"
+               << "the JS heap (private QtQml headers missing)";
+  }
+  return bOk;
+}
+
+// ----------------------------------------------------------------------------
+
+// Removes "--book-out file" and "--book-plies n" from the arguments
+bool readBookOptions(QStringList *pListArgs, QString *psBookOut,
+                     int *pnBookPlies) {
+  for (int i = 0; i < pListArgs->size(); i++) {
+    const QString sArg(pListArgs->at(i));
+    if ("--book-out" != sArg && "--book-plies" != sArg) {
+      continue;
+    }
+    if (i + 1 >= pListArgs->size()) {
+      return false;
+    }
+    const QString sValue(pListArgs->at(i + 1));
+    pListArgs->removeAt(i);
+    pListArgs->removeAt(i);
+    i--;
+    if ("--book-out" == sArg) {
+      *psBookOut = sValue;
+    } else {
+      bool bOk(false);
+      *pnBookPlies = qBound(1, sValue.toInt(&bOk),
+                            static_cast<int>(BookBuilder::MaxPlies));
+      if (!bOk) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool writeBook(const BookBuilder &book, const QString &sFile,
+               QTextStream *pOut) {
+  if (!book.write(sFile)) {
+    *pOut << "Couldn't write opening book: " << sFile << endl;
+    return false;
+  }
+  *pOut << "Opening book " << sFile << ": " << book.getGames() << " games, "
+        << book.getPositions() << " positions, " << book.getMoves()
+        << " moves" << endl;
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+
+// --arena <games> <cpu1> <cpu2> [--depth n] [--time ms] [--threads n]
+//         [--script-time ms] [--script-memory MB] [--script-gc] [--win n]
+//         [--seed n] [--tablebase file] [--book file] [--draw-repetitions n]
+//         [--max-plies n] [--clock ms] [--clock-inc ms] [--book-out file]
+//         [--book-plies n], cpu = JS script, "NativeCPU" or "MctsCPU"
+int runArena(const QStringList &sListArgs) {
+  QTextStream outStd(stdout);
+  QStringList sListRest;
+  Opponent::Options options;
+  options.nSeed = Random::timeSeed();  // Printed, for replaying a series
+  int nWinTowers(1);
+  QString sBookOut;
+  int nBookPlies(12);
+  bool bOk(readCpuOptions(sListArgs, &sListRest, &options, &nWinTowers) &&
+           readBookOptions(&sListRest, &sBookOut, &nBookPlies));
+  const int nGames(bOk && 3 == sListRest.size()
+                   ? sListRest[0].toInt(&bOk) : 0);
+
+  if (!bOk || nGames < 1) {
+    outStd << "Usage: --arena <games> <cpu1> <cpu2> [--depth n] "
+              "[--time ms] [--threads n] [--script-time ms] "
+              "[--script-memory MB] [--script-gc] [--win n] [--seed n] "
+              "[--tablebase file] [--book file] [--draw-repetitions n] "
+              "[--max-plies n] [--clock ms] [--clock-inc ms] "
+              "[--book-out file] [--book-plies n]" << endl
+           << "CPU: path of a JS script, NativeCPU or MctsCPU" << endl
+           << "--max-plies: passes are not counted" << endl;
+    return -1;
+  }
+  for (int i = 1; i <= 2; i++) {
+    if ("NativeCPU" != sListRest[i] && "MctsCPU" != sListRest[i] &&
+        !QFile::exists(sListRest[i])) {
+      outStd << "Specified file not found: " << sListRest[i] << endl;
+      return -1;
+    }
+  }
+
+  // Debug output of the engines would slow down thousands of moves
+  qInstallMessageHandler(ArenaLoggingHandler);
+  Arena arena(options, nWinTowers);
+  BookBuilder book(GameState(5, 5, 20, nWinTowers), nBookPlies);
+  arena.run(sListRest[1], sListRest[2], nGames, &outStd,
+            sBookOut.isEmpty() ? NULL : &book);
+  if (!sBookOut.isEmpty() && !writeBook(book, sBookOut, &outStd)) {
+    return -1;
+  }
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+// --tournament <games> [cpu ...] [--gauntlet] [--jobs n] + engine and book
+// options; without CPUs all scripts of the share and user "cpu" folder
+// take part
+int runTournament(const QStringList &sListArgs) {
+  QTextStream outStd(stdout);
+  QStringList sListRest;
+  Opponent::Options options;
+  options.nSeed = Random::timeSeed();  // Printed, for replaying a series
+  int nWinTowers(1);
+  QString sBookOut;
+  int nBookPlies(12);
+  bool bOk(readCpuOptions(sListArgs, &sListRest, &options, &nWinTowers) &&
+           readBookOptions(&sListRest, &sBookOut, &nBookPlies));
+  const int nGames(bOk && !sListRest.isEmpty()
+                   ? sListRest.takeFirst().toInt(&bOk) : 0);
+  Tournament::Mode mode(Tournament::RoundRobin);
+  int nJobs(QThread::idealThreadCount());
+
+  QStringList sListCpus;
+  for (int i = 0; i < sListRest.size() && bOk; i++) {
+    if ("--gauntlet" == sListRest[i]) {
+      mode = Tournament::Gauntlet;
+    } else if ("--jobs" == sListRest[i]) {
+      i++;
+      nJobs = (i < sListRest.size()) ? sListRest[i].toInt(&bOk) : 0;
+    } else if ("NativeCPU" == sListRest[i] || "MctsCPU" == sListRest[i] ||
+               QFile::exists(sListRest[i])) {
+      sListCpus << sListRest[i];
+    } else {
+      outStd << "Specified file not found: " << sListRest[i] << endl;
+      return -1;
+    }
+  }
+  if (sListCpus.isEmpty()) {
+    sListCpus << Opponent::findCpuScripts(getSharePath())
+              << Opponent::findCpuScripts(getUserDataDir().absolutePath());
+  }
+
+  if (!bOk || nGames < 1 || nJobs < 1) {
+    outStd << "Usage: --tournament <games per pairing> [cpu ...] "
+              "[--gauntlet] [--jobs n] [--depth n] [--time ms] "
+              "[--threads n] [--script-time ms] [--script-memory MB] "
+              "[--script-gc] [--win n] [--seed n] [--tablebase file] "
+              "[--book file] [--draw-repetitions n] [--max-plies n] "
+              "[--clock ms] [--clock-inc ms] [--book-out file] "
+              "[--book-plies n]" << endl
+           << "CPU: path of a JS script, NativeCPU or MctsCPU "
+              "(default: all installed scripts)" << endl
+           << "--max-plies: passes are not counted" << endl;
+    return -1;
+  }
+  if (sListCpus.size() < 2) {
+    outStd << "At least two CPUs are needed." << endl;
+    return -1;
+  }
+
+  qInstallMessageHandler(ArenaLoggingHandler);
+  Tournament tournament(options, nWinTowers);
+  BookBuilder book(GameState(5, 5, 20, nWinTowers), nBookPlies);
+  tournament.run(sListCpus, mode, nGames, nJobs, &outStd,
+                 sBookOut.isEmpty() ? NULL : &book);
+  if (!sBookOut.isEmpty() && !writeBook(book, sBookOut, &outStd)) {
+    return -1;
+  }
+  return 0;
+}
+
+void ArenaLoggingHandler(QtMsgType type,
+                         const QMessageLogContext &context,
+                         const QString &sMsg) {
+  Q_UNUSED(context);
+  if (QtDebugMsg != type) {
+    QTextStream(stderr) << sMsg << "\n";
+  }
+  if (QtFatalMsg == type) {
+    abort();
+  }
+}
@@ -0,0 +1,448 @@
+/**
+ * \file mcts.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Monte Carlo tree search with parallel playouts.
+ */
+
+#include <QThread>
+#include <QtMath>
+
+#include "./mcts.h"
+
+namespace {
+// UCB1 exploration constant (results are in the range 0..1)
+const double EXPLORATION = 1.4;
+}  // namespace
+
+/**
+ * \class MctsThread
+ * \brief Runs playouts of the Monte Carlo tree search in parallel.
+ */
+class MctsThread : public QThread {
+  public:
+    MctsThread(Mcts *pMcts, const quint64 nSeed)
+      : m_pMcts(pMcts),
+        m_nSeed(nSeed) {
+    }
+
+  protected:
+    void run() {
+      m_pMcts->work(m_nSeed);
+    }
+
+  private:
+    Mcts *m_pMcts;
+    const quint64 m_nSeed;
+};
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+Mcts::Mcts()
+  : m_nTimeMs(1000),
+    m_nMaxPlayouts(0),
+    m_nThreads(1),
+    m_pRoot(NULL),
+    m_Stop(0),
+    m_Abort(0),
+    m_nNodes(0),
+    m_nPlayouts(0),
+    m_nReusedVisits(0),
+    m_nElapsed(0) {
+}
+
+Mcts::~Mcts() {
+  this->deleteTree(m_pRoot);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// At least one of both limits has to be set
+void Mcts::setLimits(const int nTimeMs, const qint64 nMaxPlayouts) {
+  m_nTimeMs = nTimeMs;
+  m_nMaxPlayouts = nMaxPlayouts;
+  if (m_nTimeMs <= 0 && m_nMaxPlayouts <= 0) {
+    m_nTimeMs = 1000;
+  }
+}
+
+// Number of threads incl. the calling one
+void Mcts::setThreads(const quint8 nThreads) {
+  m_nThreads = qBound(1, static_cast<int>(nThreads),
+                      static_cast<int>(MaxThreads));
+}
+
+void Mcts::setSeed(const quint64 nSeed) {
+  m_Random.seed(nSeed);
+}
+
+quint8 Mcts::getThreads() const {
+  return m_nThreads;
+}
+
+qint64 Mcts::getPlayouts() const {
+  return m_nPlayouts;
+}
+
+// Visits of the subtree, which was taken over from the former search
+qint64 Mcts::getReusedVisits() const {
+  return m_nReusedVisits;
+}
+
+qint64 Mcts::getNodes() const {
+  return m_nNodes;
+}
+
+qint64 Mcts::getElapsed() const {
+  return m_nElapsed;
+}
+
+// Expected result of the chosen move for the player to move
+double Mcts::getWinRate() const {
+  const Node *pBest(this->bestChild(m_pRoot));
+  if (NULL == pBest || 0 == pBest->nVisits) {
+    return 0.5;
+  }
+  return pBest->dScore / pBest->nVisits;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+Move Mcts::findBestMove(const GameState &state) {
+  m_Timer.start();
+  m_Stop.store(0);
+  m_nPlayouts = 0;
+  m_nElapsed = 0;
+
+  Node *pSubtree(this->findSubtree(state.getKey()));
+  if (NULL != pSubtree) {
+    if (pSubtree != m_pRoot) {
+      pSubtree->pParent->children.removeOne(pSubtree);
+      pSubtree->pParent = NULL;
+      this->deleteTree(m_pRoot);
+      m_pRoot = pSubtree;
+    }
+    m_nReusedVisits = m_pRoot->nVisits;
+    m_nNodes = countNodes(m_pRoot);
+  } else {
+    this->deleteTree(m_pRoot);
+    m_pRoot = new Node(NULL, Move(), 3 - state.getCurrentPlayer());
+    m_pRoot->nKey = state.getKey();
+    m_nReusedVisits = 0;
+    m_nNodes = 1;
+  }
+  m_RootState = state;
+  if (!m_pRoot->bExpanded) {
+    this->expand(m_pRoot, m_RootState);
+  }
+
+  // Nothing to search: game over, pass or exactly one possible move
+  if (m_pRoot->bTerminal) {
+    return Move();
+  }
+  if (1 == m_pRoot->untried.size() + m_pRoot->children.size()) {
+    return m_pRoot->untried.isEmpty() ? m_pRoot->children.first()->move
+                                      : m_pRoot->untried.first();
+  }
+
+  // Seeds are taken from the game seed, see setSeed()
+  QList<MctsThread *> threads;
+  for (int i = 1; i < m_nThreads; i++) {
+    threads << new MctsThread(this, m_Random.next());
+    threads.last()->start();
+  }
+
+  this->work(m_Random.next());
+
+  m_Stop.store(1);
+  for (int i = 0; i < threads.size(); i++) {
+    threads[i]->wait();
+  }
+  qDeleteAll(threads);
+  m_nElapsed = m_Timer.elapsed();
+
+  const Node *pBest(this->bestChild(m_pRoot));
+  if (NULL == pBest) {
+    return Move();
+  }
+  return pBest->move;
+}
+
+// Called from another thread: the running and all further searches end
+// soon
+void Mcts::stop() {
+  m_Abort.store(1);
+}
+
+// ---------------------------------------------------------------------------
+
+void Mcts::work(const quint64 nSeed) {
+  quint64 nRandom(0 != nSeed ? nSeed : Q_UINT64_C(0x2545F4914F6CDD1D));
+  GameState state;
+  QVector<Move> moves;
+  moves.reserve(128);
+
+  while (0 == m_Stop.load()) {
+    state = m_RootState;
+
+    m_TreeMutex.lock();
+    Node *pLeaf(this->select(&state, &nRandom));
+    m_TreeMutex.unlock();
+
+    const quint8 nWinner(pLeaf->bTerminal ? pLeaf->nWinner
+                                          : this->playout(&state, &moves,
+                                                          &nRandom));
+
+    m_TreeMutex.lock();
+    this->backup(pLeaf, nWinner);
+    const qint64 nPlayouts(++m_nPlayouts);
+    m_TreeMutex.unlock();
+
+    if (0 != m_Abort.load() ||
+        (m_nMaxPlayouts > 0 && nPlayouts >= m_nMaxPlayouts) ||
+        (m_nTimeMs > 0 && m_Timer.elapsed() >= m_nTimeMs)) {
+      m_Stop.store(1);
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Called with locked tree: walk down by UCT and add one new node
+Mcts::Node *Mcts::select(GameState *pState, quint64 *pRandom) {
+  Node *pNode(m_pRoot);
+  pNode->nVirtualLoss++;
+
+  while (!pNode->bTerminal) {
+    if (!pNode->bExpanded) {
+      this->expand(pNode, *pState);
+      continue;
+    }
+
+    if (!pNode->untried.isEmpty() && m_nNodes < MaxNodes) {
+      const int nIndex(nextRandom(pRandom) % pNode->untried.size());
+      const Move move(pNode->untried[nIndex]);
+      pNode->untried[nIndex] = pNode->untried.last();
+      pNode->untried.removeLast();
+
+      Node *pChild(new Node(pNode, move, pState->getCurrentPlayer()));
+      if (move.isValid()) {
+        pState->applyMove(move);
+      } else {
+        pState->passTurn();
+      }
+      pChild->nKey = pState->getKey();
+      this->expand(pChild, *pState);
+      pChild->nVirtualLoss++;
+      pNode->children << pChild;
+      m_nNodes++;
+      return pChild;
+    }
+
+    if (pNode->children.isEmpty()) {  // Node limit reached
+      break;
+    }
+
+    // UCB1, virtual losses count as visits without a win
+    const double dLogParent(
+          qLn(static_cast<double>(pNode->nVisits + pNode->nVirtualLoss)));
+    Node *pBest(NULL);
+    double dBest(-1);
+    foreach (Node *pChild, pNode->children) {
+      const double dVisits(pChild->nVisits + pChild->nVirtualLoss);
+      const double dValue(pChild->dScore / dVisits +
+                          EXPLORATION * qSqrt(dLogParent / dVisits));
+      if (dValue > dBest) {
+        dBest = dValue;
+        pBest = pChild;
+      }
+    }
+
+    pNode = pBest;
+    if (pNode->move.isValid()) {
+      pState->applyMove(pNode->move);
+    } else {
+      pState->passTurn();
+    }
+    pNode->nVirtualLoss++;
+  }
+
+  return pNode;
+}
+
+// ---------------------------------------------------------------------------
+
+void Mcts::expand(Node *pNode, const GameState &state) {
+  pNode->bExpanded = true;
+  pNode->nWinner = state.getWinner();
+  if (0 != pNode->nWinner) {
+    pNode->bTerminal = true;
+    return;
+  }
+
+  state.generateMoves(&pNode->untried);
+  if (pNode->untried.isEmpty()) {
+    // Pass (stored as invalid move), if the opponent still can move
+    GameState passed(state);
+    passed.passTurn();
+    passed.generateMoves(&pNode->untried);
+    if (pNode->untried.isEmpty()) {
+      pNode->bTerminal = true;  // Tie
+    } else {
+      pNode->untried.clear();
+      pNode->untried << Move();
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+quint8 Mcts::playout(GameState *pState, QVector<Move> *pMoves,
+                     quint64 *pRandom) const {
+  for (int nPly = 0; nPly < MaxPlayoutPlies; nPly++) {
+    const quint8 nWinner(pState->getWinner());
+    if (0 != nWinner) {
+      return nWinner;
+    }
+
+    pState->generateMoves(pMoves);
+    if (pMoves->isEmpty()) {
+      pState->passTurn();
+      pState->generateMoves(pMoves);
+      if (pMoves->isEmpty()) {
+        return 0;
+      }
+    }
+    pState->applyMove(pMoves->at(nextRandom(pRandom) % pMoves->size()));
+  }
+
+  // Playout too long: decided by the conquered towers so far
+  const quint8 nWon1(pState->getWonTowers(1));
+  const quint8 nWon2(pState->getWonTowers(2));
+  if (nWon1 != nWon2) {
+    return (nWon1 > nWon2) ? 1 : 2;
+  }
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+
+// Called with locked tree
+void Mcts::backup(Node *pNode, const quint8 nWinner) {
+  for (; NULL != pNode; pNode = pNode->pParent) {
+    pNode->nVisits++;
+    pNode->nVirtualLoss--;
+    if (0 == nWinner) {
+      pNode->dScore += 0.5;
+    } else if (nWinner == pNode->nPlayer) {
+      pNode->dScore += 1;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Most visited child (more robust than the best average)
+Mcts::Node *Mcts::bestChild(Node *pNode) const {
+  Node *pBest(NULL);
+  if (NULL == pNode) {
+    return pBest;
+  }
+  foreach (Node *pChild, pNode->children) {
+    if (NULL == pBest || pChild->nVisits > pBest->nVisits) {
+      pBest = pChild;
+    }
+  }
+  return pBest;
+}
+
+// ---------------------------------------------------------------------------
+
+// Former root, or position after own move + opponents answer
+Mcts::Node *Mcts::findSubtree(const quint64 nKey) {
+  if (NULL == m_pRoot) {
+    return NULL;
+  }
+  if (nKey == m_pRoot->nKey) {
+    return m_pRoot;
+  }
+  foreach (Node *pChild, m_pRoot->children) {
+    if (nKey == pChild->nKey) {
+      return pChild;
+    }
+    foreach (Node *pGrandChild, pChild->children) {
+      if (nKey == pGrandChild->nKey) {
+        return pGrandChild;
+      }
+    }
+  }
+  return NULL;
+}
+
+// ---------------------------------------------------------------------------
+
+void Mcts::deleteTree(Node *pNode) {
+  if (NULL == pNode) {
+    return;
+  }
+  QList<Node *> stack;
+  stack << pNode;
+  while (!stack.isEmpty()) {
+    Node *pCurrent(stack.takeLast());
+    stack << pCurrent->children;
+    delete pCurrent;
+  }
+  if (pNode == m_pRoot) {
+    m_pRoot = NULL;
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+qint64 Mcts::countNodes(const Node *pNode) {
+  qint64 nCount(0);
+  QList<const Node *> stack;
+  stack << pNode;
+  while (!stack.isEmpty()) {
+    const Node *pCurrent(stack.takeLast());
+    nCount++;
+    foreach (const Node *pChild, pCurrent->children) {
+      stack << pChild;
+    }
+  }
+  return nCount;
+}
+
+// ---------------------------------------------------------------------------
+
+// xorshift64*, one generator per thread
+quint64 Mcts::nextRandom(quint64 *pRandom) {
+  *pRandom ^= *pRandom >> 12;
+  *pRandom ^= *pRandom << 25;
+  *pRandom ^= *pRandom >> 27;
+  return *pRandom * Q_UINT64_C(2685821657736338717);
+}
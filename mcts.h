@@ -0,0 +1,123 @@
+/**
+ * \file mcts.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the Monte Carlo tree search.
+ */
+
+#ifndef MCTS_H_
+#define MCTS_H_
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QVector>
+
+#include "./gamestate.h"
+#include "./random.h"
+
+/**
+ * \class Mcts
+ * \brief Monte Carlo tree search (UCT) with random playouts.
+ *
+ * All threads share one tree. Tree walks are serialized by a mutex, the
+ * playouts run in parallel; a virtual loss on the selected path makes
+ * the other threads choose different nodes meanwhile.
+ * The tree is kept between moves, the subtree of the new position is
+ * reused if it can be found two plies below the former root.
+ */
+class Mcts {
+  public:
+    enum { MaxThreads = 64, MaxNodes = 1000000, MaxPlayoutPlies = 200 };
+
+    Mcts();
+    ~Mcts();
+
+    void setLimits(const int nTimeMs, const qint64 nMaxPlayouts = 0);
+    void setThreads(const quint8 nThreads);
+    void setSeed(const quint64 nSeed);
+    Move findBestMove(const GameState &state);
+    void stop();
+
+    qint64 getPlayouts() const;
+    qint64 getReusedVisits() const;
+    qint64 getNodes() const;
+    qint64 getElapsed() const;
+    double getWinRate() const;
+    quint8 getThreads() const;
+
+  private:
+    Q_DISABLE_COPY(Mcts)
+
+    struct Node {
+      Node(Node *parent, const Move &m, const quint8 nMover)
+        : pParent(parent), move(m), nPlayer(nMover), nKey(0),
+          bExpanded(false), bTerminal(false), nWinner(0),
+          nVisits(0), nVirtualLoss(0), dScore(0) {}
+
+      Node *pParent;
+      QList<Node *> children;
+      QVector<Move> untried;
+      Move move;        // Invalid move = pass
+      quint8 nPlayer;   // Player who made the move leading to this node
+      quint64 nKey;
+      bool bExpanded;
+      bool bTerminal;
+      quint8 nWinner;   // Of a terminal node, 0 = tie
+      qint32 nVisits;
+      qint32 nVirtualLoss;
+      double dScore;    // Seen from nPlayer, win = 1, tie = 0.5
+    };
+
+    friend class MctsThread;
+
+    void work(const quint64 nSeed);
+    Node *select(GameState *pState, quint64 *pRandom);
+    void expand(Node *pNode, const GameState &state);
+    quint8 playout(GameState *pState, QVector<Move> *pMoves,
+                   quint64 *pRandom) const;
+    void backup(Node *pNode, const quint8 nWinner);
+    Node *bestChild(Node *pNode) const;
+    Node *findSubtree(const quint64 nKey);
+    void deleteTree(Node *pNode);
+    static qint64 countNodes(const Node *pNode);
+    static quint64 nextRandom(quint64 *pRandom);
+
+    int m_nTimeMs;
+    qint64 m_nMaxPlayouts;
+    quint8 m_nThreads;
+    Random m_Random;
+
+    GameState m_RootState;
+    Node *m_pRoot;
+    QMutex m_TreeMutex;
+    QElapsedTimer m_Timer;
+    QAtomicInt m_Stop;
+    QAtomicInt m_Abort;  // See stop()
+    qint64 m_nNodes;
+    qint64 m_nPlayouts;
+    qint64 m_nReusedVisits;
+    qint64 m_nElapsed;
+};
+
+#endif  // MCTS_H_
@@ -0,0 +1,103 @@
+/**
+ * \file movetables.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Precomputed ray / move tables.
+ */
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "./movetables.h"
+
+MoveTables::MoveTables(const quint8 nNumOfFields) {
+  const int nFields(nNumOfFields * nNumOfFields);
+
+  for (int nTo = 0; nTo < Position::MaxFields; nTo++) {
+    for (int nDist = 0; nDist <= Position::MaxLevels; nDist++) {
+      m_nRayCount[nTo][nDist] = 0;
+      if (nTo >= nFields || 0 == nDist) {
+        continue;
+      }
+
+      const int nToX(nTo % nNumOfFields);
+      const int nToY(nTo / nNumOfFields);
+      // Same order as the former neighbourhood check (rows, then columns)
+      for (int nDirY = -1; nDirY <= 1; nDirY++) {
+        for (int nDirX = -1; nDirX <= 1; nDirX++) {
+          const int x(nToX + nDirX * nDist);
+          const int y(nToY + nDirY * nDist);
+          if ((0 == nDirX && 0 == nDirY) ||
+              x < 0 || y < 0 || x >= nNumOfFields || y >= nNumOfFields) {
+            continue;
+          }
+
+          Ray &ray(m_Rays[nTo][nDist][m_nRayCount[nTo][nDist]]);
+          ray.nFrom = y * nNumOfFields + x;
+          ray.nBetween = 0;
+          for (int i = 1; i < nDist; i++) {
+            ray.nBetween |= 1u << ((nToY + nDirY * i) * nNumOfFields +
+                                   nToX + nDirX * i);
+          }
+          m_nRayCount[nTo][nDist]++;
+        }
+      }
+    }
+  }
+
+  for (int nSym = 0; nSym < Symmetries; nSym++) {
+    for (int nField = 0; nField < Position::MaxFields; nField++) {
+      m_nTransform[nSym][nField] = nField;
+      if (nField >= nFields) {
+        continue;
+      }
+      int x(nField % nNumOfFields);
+      int y(nField / nNumOfFields);
+      if (nSym & 4) {
+        qSwap(x, y);
+      }
+      if (nSym & 1) {
+        x = nNumOfFields - 1 - x;
+      }
+      if (nSym & 2) {
+        y = nNumOfFields - 1 - y;
+      }
+      m_nTransform[nSym][nField] = y * nNumOfFields + x;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+const MoveTables *MoveTables::instance(const quint8 nNumOfFields) {
+  // One table per board size, created on first use and never released
+  static QMutex mutex;
+  static const MoveTables *pTables[Position::MaxFields + 1] = {NULL};
+
+  Q_ASSERT(nNumOfFields * nNumOfFields <= Position::MaxFields);
+  QMutexLocker locker(&mutex);
+  if (NULL == pTables[nNumOfFields]) {
+    pTables[nNumOfFields] = new MoveTables(nNumOfFields);
+  }
+  return pTables[nNumOfFields];
+}
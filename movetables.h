@@ -0,0 +1,93 @@
+/**
+ * \file movetables.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for precomputed ray / move tables.
+ */
+
+#ifndef MOVETABLES_H_
+#define MOVETABLES_H_
+
+#include "./position.h"
+
+/**
+ * \class MoveTables
+ * \brief Per field and per distance rays, computed once for a board size.
+ *
+ * For a target field and a distance (= height of the target tower) the
+ * table holds the up to eight source fields together with a mask of the
+ * fields in between, which have to be empty for the move.
+ *
+ * Additionally the field permutations of the eight symmetries of the
+ * square board (rotations and reflections): bit 0 mirrors x, bit 1 mirrors
+ * y and bit 2 swaps x and y first. The move rule is invariant under all of
+ * them, so symmetric positions have the same game theoretic value.
+ */
+class MoveTables {
+  public:
+    struct Ray {
+      qint8 nFrom;
+      quint32 nBetween;
+    };
+    enum { Symmetries = 8 };
+
+    static const MoveTables *instance(const quint8 nNumOfFields);
+
+    quint8 rayCount(const qint8 nTo, const quint8 nDistance) const {
+      return m_nRayCount[nTo][nDistance];
+    }
+    const Ray *rays(const qint8 nTo, const quint8 nDistance) const {
+      return m_Rays[nTo][nDistance];
+    }
+
+    // Mask of all fields, from which a tower can be moved onto nTo
+    quint32 sources(const qint8 nTo, const quint8 nDistance,
+                    const quint32 nOccupied) const {
+      quint32 nMask(0);
+      const Ray *pRay(m_Rays[nTo][nDistance]);
+      for (int i = m_nRayCount[nTo][nDistance]; i > 0; i--, pRay++) {
+        if (0 == (nOccupied & pRay->nBetween)) {
+          nMask |= nOccupied & (1u << pRay->nFrom);
+        }
+      }
+      return nMask;
+    }
+
+    qint8 transform(const quint8 nSymmetry, const qint8 nField) const {
+      return m_nTransform[nSymmetry][nField];
+    }
+    static quint8 inverse(const quint8 nSymmetry) {
+      // With swapped axes, the mirroring of x and y is exchanged
+      return (nSymmetry & 4) ? (4 | ((nSymmetry & 1) << 1) |
+                                ((nSymmetry >> 1) & 1))
+                             : nSymmetry;
+    }
+
+  private:
+    explicit MoveTables(const quint8 nNumOfFields);
+
+    quint8 m_nRayCount[Position::MaxFields][Position::MaxLevels + 1];
+    Ray m_Rays[Position::MaxFields][Position::MaxLevels + 1][8];
+    qint8 m_nTransform[Symmetries][Position::MaxFields];
+};
+
+#endif  // MOVETABLES_H_
@@ -0,0 +1,233 @@
+/**
+ * \file openingbook.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Opening book, memory mapped.
+ */
+
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+
+#include "./openingbook.h"
+
+namespace {
+const char MAGIC[8] = {'S', 'A', 'C', 'B', 'K', '0', '0', '1'};
+const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+QMutex booksMutex;
+QHash<QString, OpeningBook *> books;  // Also failed files (NULL)
+
+void deleteBooks() {
+  QMutexLocker locker(&booksMutex);
+  qDeleteAll(books);
+  books.clear();
+}
+}  // namespace
+
+OpeningBook::OpeningBook()
+  : m_pKeys(NULL),
+    m_pMoves(NULL),
+    m_pGames(NULL),
+    m_pPoints(NULL) {
+  memset(&m_Header, 0, sizeof(m_Header));
+}
+
+OpeningBook::~OpeningBook() {
+  m_File.close();  // Unmaps the file
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Opened only once per file and shared by all opponents; NULL if the file
+// is missing or invalid
+const OpeningBook *OpeningBook::open(const QString &sFile) {
+  if (sFile.isEmpty()) {
+    return NULL;
+  }
+  QMutexLocker locker(&booksMutex);
+  if (books.contains(sFile)) {
+    return books.value(sFile);
+  }
+  if (books.isEmpty()) {
+    qAddPostRoutine(deleteBooks);
+  }
+
+  OpeningBook *pBook(new OpeningBook());
+  if (!pBook->map(sFile)) {
+    delete pBook;
+    pBook = NULL;
+  } else {
+    qDebug() << "Opening book" << sFile << "-" << pBook->size() << "moves";
+  }
+  books.insert(sFile, pBook);
+  return pBook;
+}
+
+bool OpeningBook::map(const QString &sFile) {
+  m_File.setFileName(sFile);
+  if (!m_File.open(QIODevice::ReadOnly)) {
+    qWarning() << "Couldn't open opening book:" << sFile;
+    return false;
+  }
+  if (m_File.read(reinterpret_cast<char *>(&m_Header), sizeof(m_Header)) !=
+      sizeof(m_Header) ||
+      0 != memcmp(m_Header.sMagic, MAGIC, sizeof(MAGIC)) ||
+      BYTE_ORDER_MARK != m_Header.nByteOrder) {
+    qWarning() << "Invalid opening book (or other byte order):" << sFile;
+    return false;
+  }
+  Header check;
+  fillHeader(&check, GameState(), 0);
+  if (check.nCheckKey != m_Header.nCheckKey) {
+    qWarning() << "Opening book was generated with other hash keys:" << sFile;
+    return false;
+  }
+
+  const qint64 nSize(sizeof(Header) + static_cast<qint64>(m_Header.nCount) *
+                     (sizeof(quint64) + 3 * sizeof(quint16)));
+  if (m_File.size() != nSize) {
+    qWarning() << "Opening book size doesn't match:" << sFile;
+    return false;
+  }
+  const uchar *pData(m_File.map(0, nSize));
+  if (NULL == pData) {
+    qWarning() << "Couldn't map opening book:" << sFile;
+    return false;
+  }
+  m_pKeys = reinterpret_cast<const quint64 *>(pData + sizeof(Header));
+  m_pMoves = reinterpret_cast<const quint16 *>(m_pKeys + m_Header.nCount);
+  m_pGames = m_pMoves + m_Header.nCount;
+  m_pPoints = m_pGames + m_Header.nCount;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool OpeningBook::write(const QString &sFile, const GameState &rules,
+                        QVector<Entry> *pEntries) {
+  qSort(pEntries->begin(), pEntries->end());
+  Header header;
+  fillHeader(&header, rules, pEntries->size());
+
+  QFile file(sFile);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Couldn't write opening book:" << sFile;
+    return false;
+  }
+  const int nCount(pEntries->size());
+  QVector<quint64> keys(nCount);
+  QVector<quint16> values(3 * nCount);  // Moves, games, points
+  for (int i = 0; i < nCount; i++) {
+    keys[i] = pEntries->at(i).nKey;
+    values[i] = pEntries->at(i).nMove;
+    values[nCount + i] = pEntries->at(i).nGames;
+    values[2 * nCount + i] = pEntries->at(i).nPoints;
+  }
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(keys.constData()),
+             keys.size() * sizeof(quint64));
+  file.write(reinterpret_cast<const char *>(values.constData()),
+             values.size() * sizeof(quint16));
+  file.close();
+  return QFile::NoError == file.error();
+}
+
+void OpeningBook::fillHeader(Header *pHeader, const GameState &rules,
+                             const quint32 nCount) {
+  memset(pHeader, 0, sizeof(Header));
+  memcpy(pHeader->sMagic, MAGIC, sizeof(MAGIC));
+  pHeader->nByteOrder = BYTE_ORDER_MARK;
+  pHeader->nCount = nCount;
+  pHeader->nCheckKey = Zobrist::tower(0, 1, 0) ^ Zobrist::side();
+  pHeader->nNumOfFields = rules.getNumOfFields();
+  pHeader->nMaxTowerHeight = rules.getMaxTowerHeight();
+  pHeader->nMaxStones = rules.getMaxStones();
+  pHeader->nWinTowers = rules.getWinTowers();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Bits 0-5: source field + 1 (0 = set stone), 6-10: target, 11-13: stones
+quint16 OpeningBook::packMove(const Move &move) {
+  return static_cast<quint16>((move.nFrom + 1) | (move.nTo << 6) |
+                              (move.nStones << 11));
+}
+
+Move OpeningBook::unpackMove(const quint16 nMove) {
+  return Move(static_cast<qint8>(nMove & 0x3F) - 1, (nMove >> 6) & 0x1F,
+              (nMove >> 11) & 0x07);
+}
+
+// Move with the best average result, which was played at least MinGames
+// times; invalid move if the position is not in the book
+Move OpeningBook::probe(const GameState &state) const {
+  if (0 == m_Header.nCount ||
+      state.getNumOfFields() != m_Header.nNumOfFields ||
+      state.getMaxTowerHeight() != m_Header.nMaxTowerHeight ||
+      state.getMaxStones() != m_Header.nMaxStones ||
+      state.getWinTowers() != m_Header.nWinTowers) {
+    return Move();
+  }
+
+  quint8 nSymmetry(0);
+  const quint64 nKey(state.getCanonicalKey(&nSymmetry));
+  const quint64 *pEnd(m_pKeys + m_Header.nCount);
+  int nBest(-1);
+  for (const quint64 *pKey(qLowerBound(m_pKeys, pEnd, nKey));
+       pEnd != pKey && *pKey == nKey; pKey++) {
+    const int i(pKey - m_pKeys);
+    if (m_pGames[i] < MinGames) {
+      continue;
+    }
+    // Points / games compared without division
+    if (-1 == nBest ||
+        static_cast<quint32>(m_pPoints[i]) * m_pGames[nBest] >
+        static_cast<quint32>(m_pPoints[nBest]) * m_pGames[i] ||
+        (static_cast<quint32>(m_pPoints[i]) * m_pGames[nBest] ==
+         static_cast<quint32>(m_pPoints[nBest]) * m_pGames[i] &&
+         m_pGames[i] > m_pGames[nBest])) {
+      nBest = i;
+    }
+  }
+  if (-1 == nBest) {
+    return Move();
+  }
+
+  const Move move(state.transformMove(unpackMove(m_pMoves[nBest]),
+                                      MoveTables::inverse(nSymmetry)));
+  if (GameState::MoveOk != state.checkMove(move)) {
+    return Move();
+  }
+  return move;
+}
+
+quint32 OpeningBook::size() const {
+  return m_Header.nCount;
+}
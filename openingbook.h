@@ -0,0 +1,111 @@
+/**
+ * \file openingbook.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the opening book.
+ */
+
+#ifndef OPENINGBOOK_H_
+#define OPENINGBOOK_H_
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "./gamestate.h"
+
+/**
+ * \class OpeningBook
+ * \brief Memory mapped table of moves played in the opening (see
+ *        BookBuilder), with their results.
+ *
+ * File: Header, canonical Zobrist keys (quint64, sorted, one entry per
+ * position and move), moves (quint16, in the frame of the canonical
+ * position), games and points (quint16 each, win = 2, tie = 1) in the byte
+ * order of the generating machine.
+ */
+class OpeningBook {
+  public:
+    enum { MinGames = 2 };
+
+    /**
+     * \struct Entry
+     * \brief Statistics of one move in one position.
+     */
+    struct Entry {
+      Entry() : nKey(0), nMove(0), nGames(0), nPoints(0) {}
+      Entry(const quint64 key, const quint16 move)
+        : nKey(key), nMove(move), nGames(0), nPoints(0) {}
+      bool operator<(const Entry &other) const {
+        return nKey < other.nKey ||
+            (nKey == other.nKey && nMove < other.nMove);
+      }
+
+      quint64 nKey;
+      quint16 nMove;
+      quint16 nGames;
+      quint16 nPoints;
+    };
+
+    ~OpeningBook();
+    static const OpeningBook *open(const QString &sFile);
+    static bool write(const QString &sFile, const GameState &rules,
+                      QVector<Entry> *pEntries);
+    Move probe(const GameState &state) const;
+    quint32 size() const;
+
+    static quint16 packMove(const Move &move);
+    static Move unpackMove(const quint16 nMove);
+
+  private:
+    Q_DISABLE_COPY(OpeningBook)
+
+    /**
+     * \struct Header
+     * \brief Start of the file, the rules have to match the probed game.
+     */
+    struct Header {
+      char sMagic[8];
+      quint32 nByteOrder;
+      quint32 nCount;
+      quint64 nCheckKey;   // Same Zobrist keys as the generator
+      quint8 nNumOfFields;
+      quint8 nMaxTowerHeight;
+      quint8 nMaxStones;
+      quint8 nWinTowers;
+      quint32 nReserved;
+    };
+
+    OpeningBook();
+    bool map(const QString &sFile);
+    static void fillHeader(Header *pHeader, const GameState &rules,
+                           const quint32 nCount);
+
+    QFile m_File;
+    Header m_Header;
+    const quint64 *m_pKeys;
+    const quint16 *m_pMoves;
+    const quint16 *m_pGames;
+    const quint16 *m_pPoints;
+};
+
+#endif  // OPENINGBOOK_H_
@@ -0,0 +1,127 @@
+/**
+ * \file opponent.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Common interface of all CPU opponents.
+ */
+
+#include <QDebug>
+#include <QDir>
+
+#include "./clock.h"
+#include "./opponent.h"
+#include "./opponentjs.h"
+#include "./opponentmcts.h"
+#include "./opponentnative.h"
+#include "./tablebase.h"
+
+Opponent::Opponent(const quint8 nID, QObject *pParent)
+  : QObject(pParent),
+    m_nID(nID),
+    m_pBook(NULL),
+    m_nClockRemaining(-1),
+    m_nClockIncrement(0) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// sCpu: "NativeCPU", "MctsCPU" or path of a JS script
+Opponent *Opponent::create(const quint8 nID, const QString &sCpu,
+                           const Options &options, const quint8 nNumOfFields,
+                           const quint8 nMaxTowerHeight, QObject *pParent) {
+  Opponent *pCpu(NULL);
+  if ("NativeCPU" == sCpu) {
+    pCpu = new OpponentNative(nID, options.nSearchDepth, options.nSearchTime,
+                              options.nThreads, options.nHashSizeMB,
+                              options.nHashReplacement,
+                              Tablebase::open(options.sTablebase), pParent);
+  } else if ("MctsCPU" == sCpu) {
+    pCpu = new OpponentMcts(nID, options.nSearchTime, options.nThreads,
+                            options.nSeed, pParent);
+  } else {
+    pCpu = new OpponentJS(nID, nNumOfFields, nMaxTowerHeight,
+                          options.nScriptTimeLimit, options.nScriptMemoryMB,
+                          options.bScriptGc, options.nSeed, pParent);
+  }
+  pCpu->setBook(OpeningBook::open(options.sBook));
+  return pCpu;
+}
+
+void Opponent::setBook(const OpeningBook *pBook) {
+  m_pBook = pBook;
+}
+
+// Emits the book move, if the position is in the opening book
+bool Opponent::playBookMove(const GameState &state) {
+  if (NULL == m_pBook) {
+    return false;
+  }
+  const Move move(m_pBook->probe(state));
+  if (!move.isValid()) {
+    return false;
+  }
+  qDebug() << "CPU" << m_nID << "book move:" << state.moveToString(move);
+  emit madeMove(move);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+// Remaining time of the own clock, set before each move; -1 = no clock
+void Opponent::setClock(const qint64 nRemainingMs, const int nIncrementMs) {
+  m_nClockRemaining = nRemainingMs;
+  m_nClockIncrement = nIncrementMs;
+}
+
+// Target and hard limit for the next move, unchanged without clock
+bool Opponent::moveTime(int *pTargetMs, int *pMaxMs) const {
+  if (m_nClockRemaining < 0) {
+    return false;
+  }
+  *pTargetMs = Clock::allocate(m_nClockRemaining, m_nClockIncrement, pMaxMs);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+// Called after each move of both players, nothing to do by default
+void Opponent::moveApplied(const Move &move, const quint8 nPlayer) {
+  Q_UNUSED(move);
+  Q_UNUSED(nPlayer);
+}
+
+// ---------------------------------------------------------------------------
+
+// Absolute paths of all CPU scripts in the "cpu" folder of sDataDir
+QStringList Opponent::findCpuScripts(const QString &sDataDir) {
+  QStringList sListScripts;
+  QDir cpuDir(sDataDir);
+  if (cpuDir.cd("cpu")) {
+    foreach (QFileInfo file, cpuDir.entryInfoList(QDir::Files)) {
+      if ("js" == file.suffix().toLower()) {
+        sListScripts << file.absoluteFilePath();
+      }
+    }
+  }
+  return sListScripts;
+}
@@ -0,0 +1,109 @@
+/**
+ * \file opponent.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Common interface of all CPU opponents.
+ */
+
+#ifndef OPPONENT_H_
+#define OPPONENT_H_
+
+#include <QObject>
+#include <QStringList>
+
+#include "./gamestate.h"
+#include "./openingbook.h"
+
+/**
+ * \class Opponent
+ * \brief Base class for CPU opponents (JS script or native engine).
+ *
+ * Game calls makeMoveCpu() with the current state, the opponent answers
+ * with madeMove(). Failures are reported by scriptError() with a reason and
+ * the ID of the failing opponent, which need not be the one to move (e.g.
+ * an exception in a move callback of a script).
+ * Positions of the opening book are answered without asking the engine.
+ * With a game clock, setClock() passes the remaining time before each move
+ * and the engines divide it by themselves.
+ */
+class Opponent : public QObject {
+  Q_OBJECT
+
+  public:
+    /**
+     * \struct Options
+     * \brief Limits of the native engines, the CPU scripts and the game.
+     */
+    struct Options {
+      Options()
+        : nSearchDepth(8), nSearchTime(1000), nThreads(1),
+          nHashSizeMB(32), nHashReplacement(2), nScriptTimeLimit(10000),
+          nScriptMemoryMB(0), bScriptGc(false), nSeed(0),
+          nDrawRepetitions(3), nMaxPlies(1000), nClockTime(0),
+          nClockIncrement(0) {}
+
+      quint8 nSearchDepth;
+      int nSearchTime;
+      quint8 nThreads;
+      quint32 nHashSizeMB;
+      quint8 nHashReplacement;
+      int nScriptTimeLimit;  // JS scripts: ms per move, then loss by timeout
+      quint32 nScriptMemoryMB;  // JS heap limit, then loss; 0 = no limit
+      bool bScriptGc;        // Garbage collection after each script move
+      quint64 nSeed;         // Random numbers of scripts and MCTS
+      QString sTablebase;    // NativeCPU: file of solved endgames
+      QString sBook;         // Opening book, used by all CPUs
+      quint8 nDrawRepetitions;  // Position occurred n times = tie, 0 = off
+      quint16 nMaxPlies;     // Longer games end in a tie
+      int nClockTime;        // Game clock: ms per player, 0 = no clock
+      int nClockIncrement;   // Game clock: ms added after each move
+    };
+
+    explicit Opponent(const quint8 nID, QObject *pParent = 0);
+    static Opponent *create(const quint8 nID, const QString &sCpu,
+                            const Options &options, const quint8 nNumOfFields,
+                            const quint8 nMaxTowerHeight,
+                            QObject *pParent = 0);
+    static QStringList findCpuScripts(const QString &sDataDir);
+    virtual bool initCpu(const QString &sCpu) = 0;
+    void setBook(const OpeningBook *pBook);
+    void setClock(const qint64 nRemainingMs, const int nIncrementMs);
+
+  public slots:
+    virtual void makeMoveCpu(const GameState &state) = 0;
+    virtual void moveApplied(const Move &move, const quint8 nPlayer);
+
+  signals:
+    void madeMove(const Move &move);
+    void scriptError(const QString &sError, const quint8 nID);
+
+  protected:
+    bool playBookMove(const GameState &state);
+    bool moveTime(int *pTargetMs, int *pMaxMs) const;
+
+    const quint8 m_nID;
+    const OpeningBook *m_pBook;
+    qint64 m_nClockRemaining;  // -1 = no clock
+    int m_nClockIncrement;
+};
+
+#endif  // OPPONENT_H_
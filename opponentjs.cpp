@@ -25,192 +25,173 @@
  */
 
 #include <QDebug>
-#include <QFile>
-#include <QMessageBox>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
+#include <QEventLoop>
+#include <QFileInfo>
 
 #include "./opponentjs.h"
+#include "./scriptpool.h"
+#include "./scriptrunner.h"
 
 OpponentJS::OpponentJS(const quint8 nID, const quint8 nNumOfFields,
-                       const quint8 nHeightTowerWin, QObject *parent)
-  : QObject(parent),
-    m_nID(nID),
+                       const quint8 nHeightTowerWin, const int nTimeLimitMs,
+                       const quint32 nMemoryLimitMB,
+                       const bool bCollectGarbage, const quint64 nSeed,
+                       QObject *pParent)
+  : Opponent(nID, pParent),
     m_nNumOfFields(nNumOfFields),
     m_nHeightTowerWin(nHeightTowerWin),
-    m_jsEngine(new QJSEngine(parent)) {
-  m_obj = m_jsEngine->globalObject();
-  m_obj.setProperty("cpu", m_jsEngine->newQObject(this));
+    m_nTimeLimit(nTimeLimitMs),
+    m_nMemoryLimitMB(nMemoryLimitMB),
+    m_bCollectGarbage(bCollectGarbage),
+    m_nSeed(nSeed),
+    m_pRunner(NULL),
+    m_bReusable(true),
+    m_nMoveNo(0),
+    m_bThinking(false),
+    m_bLoaded(false) {
+  qRegisterMetaType<GameState>("GameState");
+  qRegisterMetaType<Move>("Move");
+
+  m_Watchdog.setSingleShot(true);
+  connect(&m_Watchdog, SIGNAL(timeout()), this, SLOT(timeout()));
+}
 
-  // TODO(volunteer): C++ call via CPU script for check previous move reverted?
+// Runner goes back to the pool, if it is idle and had no error
+OpponentJS::~OpponentJS() {
+  if (NULL != m_pRunner) {
+    this->disconnect(m_pRunner);
+    m_pRunner->disconnect(this);
+
+    // Timing of the whole game, see ScriptStats for the stages
+    m_Stats.merge(m_pRunner->takeStats());
+    if (!m_Stats.isEmpty()) {
+      const QString sName(QFileInfo(m_sScript).baseName());
+      qDebug() << "CPU" << m_nID << qPrintable(sName) << "timing:";
+      foreach (const QString &sLine, m_Stats.toString("  ").split('\n')) {
+        qDebug() << qPrintable(sLine);
+      }
+      ScriptStats::addToTotals(sName, m_Stats);
+    }
+    ScriptPool::instance()->release(m_pRunner,
+                                    m_bReusable && !m_bThinking);
+  }
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-bool OpponentJS::loadAndEvalCpuScript(const QString &sFilepath) {
-  QFile f(sFilepath);
-  if (!f.open(QFile::ReadOnly)) {
-    qWarning() << "Couldn't open JS file:" << sFilepath;
-    return false;
-  }
-  QString source = QString::fromUtf8(f.readAll());
-  f.close();
-  qDebug() << "CPU" << m_nID << "script:" << sFilepath;
-
-  QJSValue result(m_jsEngine->evaluate(source, sFilepath));
-  if (result.isError()) {
-    qCritical() << "Error in CPU" << m_nID << "script at line" <<
-                   result.property("lineNumber").toInt() <<
-                   "\n" << result.toString();
-    emit scriptError();
-    return false;
+// Loading uses the same time limit as a move
+bool OpponentJS::initCpu(const QString &sCpu) {
+  if (NULL == m_pRunner) {
+    m_sScript = sCpu;
+    m_pRunner = ScriptPool::instance()->acquire(sCpu, m_nNumOfFields,
+                                                m_nHeightTowerWin);
+    connect(this, SIGNAL(loadScript(QString, quint8, quint64)),
+            m_pRunner, SLOT(load(QString, quint8, quint64)));
+    connect(this, SIGNAL(startMove(GameState, quint32, int)),
+            m_pRunner, SLOT(makeMove(GameState, quint32, int)));
+    connect(this, SIGNAL(forwardMove(Move, quint8)),
+            m_pRunner, SLOT(moveApplied(Move, quint8)));
+    connect(m_pRunner, SIGNAL(loaded(bool)),
+            this, SLOT(scriptLoaded(bool)));
+    connect(m_pRunner, SIGNAL(madeMove(Move, quint32)),
+            this, SLOT(receivedMove(Move, quint32)));
+    connect(m_pRunner, SIGNAL(scriptError(QString, quint32)),
+            this, SLOT(receivedError(QString, quint32)));
   }
 
-  // Check if makeMove() is available for calling the script
-  if (!m_obj.hasProperty("makeMove") ||
-      !m_obj.property("makeMove").isCallable()) {
-    qCritical() << "Error in CPU" << m_nID << "script - function makeMove() " <<
-                   "not found or not callable!";
-    emit scriptError();
+  QEventLoop loop;
+  QTimer timer;
+  timer.setSingleShot(true);
+  connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+  connect(m_pRunner, SIGNAL(loaded(bool)), &loop, SLOT(quit()));
+
+  m_bLoaded = false;
+  m_pRunner->setMemoryLimit(m_nMemoryLimitMB, m_bCollectGarbage);
+  timer.start(m_nTimeLimit);
+  emit loadScript(sCpu, m_nID, m_nSeed);
+  loop.exec();
+
+  if (!timer.isActive()) {
+    m_pRunner->interrupt();
+    m_bReusable = false;
+    qCritical() << "CPU" << m_nID << "script not loaded within"
+                << m_nTimeLimit << "ms";
     return false;
   }
+  m_bReusable = m_bLoaded;
+  return m_bLoaded;
+}
 
-  m_obj.setProperty("nID", m_nID);
-  m_obj.setProperty("nNumOfFields", m_nNumOfFields);
-  m_obj.setProperty("nHeightTowerWin", m_nHeightTowerWin);
-  return true;
+void OpponentJS::scriptLoaded(bool bOk) {
+  m_bLoaded = bOk;
 }
 
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void OpponentJS::makeMoveCpu(const QList<QList<QList<quint8> > > board,
-                             const quint8 nPossibleMove) {
-  QJsonDocument jsdoc(this->convertBoardToJSON(board));
-
-  QString sJsBoard(jsdoc.toJson(QJsonDocument::Compact));
-  m_obj.setProperty("jsboard", sJsBoard);
-
-  QJSValue result = m_obj.property("makeMove")
-                    .call(QJSValueList() << nPossibleMove);
-  if (result.isError()) {
-    qCritical() << "CPU" << m_nID <<
-                   "- Error calling \"makeMove\" function at line:" <<
-                   result.property("lineNumber").toInt() <<
-                   "\n" << result.toString();
-    QMessageBox::warning(NULL, trUtf8("Warning"),
-                         trUtf8("CPU script execution error! "
-                                "Please check the debug log."));
-    emit scriptError();
+void OpponentJS::makeMoveCpu(const GameState &state) {
+  if (this->playBookMove(state)) {
+    return;
   }
-
-  // qDebug() << "Result of makeMove():" << result.toString();
-  QList<QPoint> listRet;
-  listRet = this->evalMoveReturn(result.toString());
-  // qDebug() << "RET" << listRet;
-
-  if (1 == listRet.size()) {
-    if (listRet[0].x() >= 0 && listRet[0].y() >= 0 &&
-        listRet[0].x() < m_nNumOfFields && listRet[0].y() < m_nNumOfFields) {
-      emit setStone(listRet[0]);
-      return;
-    }
-  } else if (3 == listRet.size()) {
-    if (listRet[0].x() >= 0 && listRet[0].y() >= 0 &&
-        listRet[0].x() < m_nNumOfFields && listRet[0].y() < m_nNumOfFields &&
-        listRet[1].x() >= 0 && listRet[1].y() >= 0 &&
-        listRet[1].x() < m_nNumOfFields && listRet[1].y() < m_nNumOfFields &&
-        listRet[2].x() > 0 && listRet[2].x() < m_nHeightTowerWin) {
-      emit moveTower(listRet[0], listRet[1], quint8(listRet[2].x()));
-      return;
-    }
+  // With a game clock the game detects the loss on time, the watchdog only
+  // ends a script, which would block the game much longer
+  int nTargetMs(-1);
+  int nMaxMs(0);
+  int nWatchdogMs(m_nTimeLimit);
+  if (this->moveTime(&nTargetMs, &nMaxMs)) {
+    nWatchdogMs = static_cast<int>(qBound(Q_INT64_C(1),
+                                          m_nClockRemaining + 500,
+                                          static_cast<qint64>(m_nTimeLimit)));
   }
+  m_nMoveNo++;
+  m_bThinking = true;
+  m_MoveTimer.start();
+  m_Watchdog.start(nWatchdogMs);
+  emit startMove(state, m_nMoveNo, nTargetMs);
+}
 
-  qCritical() << "CPU" << m_nID << "script invalid return from makeMove():" <<
-                 result.toString();
-  QMessageBox::warning(NULL, trUtf8("Warning"),
-                       trUtf8("CPU script execution error! "
-                              "Please check the debug log."));
-  emit scriptError();
+void OpponentJS::moveApplied(const Move &move, const quint8 nPlayer) {
+  emit forwardMove(move, nPlayer);
 }
 
-// ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-QJsonDocument OpponentJS::convertBoardToJSON(
-    const QList<QList<QList<quint8> > > board) {
-  QJsonArray tower;
-  QVariantList vartower;
-  QJsonArray jsBoard;
-
-  for (int nRow = 0; nRow < m_nNumOfFields; nRow++) {
-    QJsonArray line;
-    for (int nCol = 0; nCol < m_nNumOfFields; nCol++) {
-      vartower.clear();
-      foreach (quint8 n, board[nRow][nCol]) {
-        vartower << n;
-      }
-      tower = QJsonArray::fromVariantList(vartower);
-      line.append(tower);
-    }
-    jsBoard.append(line);
+// Results of a move, which ran into the timeout, are ignored
+void OpponentJS::receivedMove(const Move &move, const quint32 nMoveNo) {
+  if (!m_bThinking || nMoveNo != m_nMoveNo) {
+    return;
   }
-
-  QJsonDocument jsDoc(jsBoard);
-  return jsDoc;
+  m_Watchdog.stop();
+  m_bThinking = false;
+  m_Stats.add(ScriptStats::Turn, m_MoveTimer.nsecsElapsed());
+  qDebug() << "CPU" << m_nID << "script time:" << m_MoveTimer.elapsed()
+           << "ms";
+  emit madeMove(move);
 }
 
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-QList<QPoint> OpponentJS::evalMoveReturn(QString sReturn) {
-  QList<QPoint> listReturn;
-  QStringList sListRet;
-  QStringList sListPoint;
-  QPoint point;
-  bool bOk1(true);
-  bool bOk2(true);
-
-  sListRet = sReturn.split("|");
-  for (int i = 0; i < sListRet.size(); i++) {
-    sListPoint.clear();
-
-    sListPoint = sListRet[i].split(",");
-    if (2 == sListPoint.size() && (0 == i || 1 == i)) {
-      point.setX(sListPoint[0].trimmed().toInt(&bOk1, 10));
-      point.setY(sListPoint[1].trimmed().toInt(&bOk2, 10));
-
-      if (!bOk1 || !bOk2) {
-        // In case of error, return empty list
-        listReturn.clear();
-        break;
-      } else {
-        listReturn.append(point);
-      }
-    } else if (2 == i) {  // Third value in list is only one int
-      point.setX(sListRet[i].trimmed().toInt(&bOk1, 10));
-      point.setY(-1);
-
-      if (!bOk1) {
-        listReturn.clear();
-        break;
-      } else {
-        listReturn.append(point);
-      }
-    } else {
-      listReturn.clear();
-      break;
+// nMoveNo = 0: error in a callback outside of makeMove()
+void OpponentJS::receivedError(const QString &sError, const quint32 nMoveNo) {
+  if (0 != nMoveNo) {
+    if (!m_bThinking || nMoveNo != m_nMoveNo) {
+      return;
     }
+    m_Watchdog.stop();
+    m_bThinking = false;
   }
-
-  return listReturn;
+  m_bReusable = false;
+  emit scriptError(sError, m_nID);
 }
 
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-void OpponentJS::log(const QString &sMsg) const {
-  qDebug() << sMsg;
+void OpponentJS::timeout() {
+  if (!m_bThinking) {
+    return;
+  }
+  m_bThinking = false;
+  m_bReusable = false;
+  m_pRunner->interrupt();
+  qCritical() << "CPU" << m_nID << "script exceeded time limit of"
+              << m_Watchdog.interval() << "ms";
+  emit scriptError(QString("Timeout, no move within %1 ms")
+                   .arg(m_Watchdog.interval()), m_nID);
 }
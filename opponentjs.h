@@ -27,38 +27,70 @@
 #ifndef OPPONENTJS_H_
 #define OPPONENTJS_H_
 
-#include <QObject>
-#include <QPoint>
-#include <QJSEngine>
+#include <QElapsedTimer>
+#include <QTimer>
 
-class OpponentJS : public QObject {
+#include "./opponent.h"
+#include "./scriptstats.h"
+
+class ScriptRunner;
+
+/**
+ * \class OpponentJS
+ * \brief CPU opponent running a JS script in an own thread.
+ *
+ * The script runner is taken from the ScriptPool and given back after
+ * the game. A move, which is not finished within the time limit, is
+ * reported as script error and the engine is interrupted. The same
+ * applies to a script exceeding the memory limit (checked after each move
+ * and during a move by the helper calls, see ScriptRunner).
+ */
+class OpponentJS : public Opponent {
   Q_OBJECT
 
   public:
-    explicit OpponentJS(const quint8 nID, const quint8 nNumOfFields,
-                        const quint8 nHeightTowerWin, QObject *parent = 0);
-    bool loadAndEvalCpuScript(const QString &sFilepath);
+    OpponentJS(const quint8 nID, const quint8 nNumOfFields,
+               const quint8 nHeightTowerWin, const int nTimeLimitMs,
+               const quint32 nMemoryLimitMB, const bool bCollectGarbage,
+               const quint64 nSeed, QObject *pParent = 0);
+    ~OpponentJS();
+    bool initCpu(const QString &sCpu);
 
   public slots:
-    void makeMoveCpu(const QList<QList<QList<quint8> > > board,
-                     const quint8 nPossibleMove);
-    void log(const QString &sMsg) const;
+    void makeMoveCpu(const GameState &state);
+    void moveApplied(const Move &move, const quint8 nPlayer);
 
   signals:
-    void setStone(QPoint field);
-    void moveTower(QPoint tower, QPoint moveTo, quint8 nStones = 0);
-    void scriptError();
+    void loadScript(const QString &sFilepath, const quint8 nID,
+                    const quint64 nSeed);
+    void startMove(const GameState &state, const quint32 nMoveNo,
+                   const int nTargetMs);
+    void forwardMove(const Move &move, const quint8 nPlayer);
+
+  private slots:
+    void scriptLoaded(bool bOk);
+    void receivedMove(const Move &move, const quint32 nMoveNo);
+    void receivedError(const QString &sError, const quint32 nMoveNo);
+    void timeout();
 
   private:
-    QJsonDocument convertBoardToJSON(const QList<QList<QList<quint8> > > board);
-    QList<QPoint> evalMoveReturn(QString sReturn);
+    Q_DISABLE_COPY(OpponentJS)
 
-    const quint8 m_nID;
     const quint8 m_nNumOfFields;
     const quint8 m_nHeightTowerWin;
-    QJSEngine *m_jsEngine;
-    QJSValue m_obj;
-    QList<QList<QList<quint8> > > m_board;
+    const int m_nTimeLimit;
+    const quint32 m_nMemoryLimitMB;
+    const bool m_bCollectGarbage;
+    const quint64 m_nSeed;
+    QString m_sScript;
+    ScriptRunner *m_pRunner;
+    bool m_bReusable;
+    QTimer m_Watchdog;
+    QElapsedTimer m_MoveTimer;
+    quint32 m_nMoveNo;
+    bool m_bThinking;
+    bool m_bLoaded;
+    ScriptStats m_Stats;  // Turn times, the runner measures the other stages
 };
 
 #endif  // OPPONENTJS_H_
@@ -0,0 +1,116 @@
+/**
+ * \file opponentmcts.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Monte Carlo tree search CPU opponent.
+ */
+
+#include <QDebug>
+
+#include "./opponentmcts.h"
+
+MctsRunner::MctsRunner(const quint8 nID, const quint8 nThreads,
+                       const quint64 nSeed)
+  : m_nID(nID) {
+  m_Mcts.setThreads(nThreads);
+  m_Mcts.setSeed(nSeed);
+}
+
+// The playouts have no natural end, the target time is used completely
+Move MctsRunner::think(const GameState &state, const History &history,
+                       const int nTargetMs, const int nMaxMs) {
+  Q_UNUSED(history);
+  Q_UNUSED(nMaxMs);
+  m_Mcts.setLimits(nTargetMs);
+  const Move move(m_Mcts.findBestMove(state));
+  if (move.isValid()) {
+    const qint64 nElapsed(qMax(Q_INT64_C(1), m_Mcts.getElapsed()));
+    qDebug() << "CPU" << m_nID << "move:" << state.moveToString(move)
+             << "- playouts:" << m_Mcts.getPlayouts()
+             << "playouts/s:" << m_Mcts.getPlayouts() * 1000 / nElapsed
+             << "reused visits:" << m_Mcts.getReusedVisits()
+             << "nodes:" << m_Mcts.getNodes()
+             << "threads:" << m_Mcts.getThreads()
+             << "win rate:" << m_Mcts.getWinRate();
+  }
+  return move;
+}
+
+void MctsRunner::interrupt() {
+  m_Mcts.stop();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+OpponentMcts::OpponentMcts(const quint8 nID, const int nTimeMs,
+                           const quint8 nThreads, const quint64 nSeed,
+                           QObject *pParent)
+  : Opponent(nID, pParent),
+    m_nTimeMs(nTimeMs),
+    m_pRunner(new MctsRunner(nID, nThreads, nSeed)),
+    m_nMoveNo(0) {
+  connect(this, SIGNAL(startSearch(GameState, History, int, int, quint32)),
+          m_pRunner, SLOT(makeMove(GameState, History, int, int, quint32)));
+  connect(m_pRunner, SIGNAL(madeMove(Move, quint32)),
+          this, SLOT(receivedMove(Move, quint32)));
+  m_pRunner->start();
+}
+
+// A running search is stopped
+OpponentMcts::~OpponentMcts() {
+  m_pRunner->finish();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool OpponentMcts::initCpu(const QString &sCpu) {
+  qDebug() << "CPU" << m_nID << "engine:" << sCpu;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void OpponentMcts::makeMoveCpu(const GameState &state) {
+  if (this->playBookMove(state)) {
+    return;
+  }
+  int nTargetMs(m_nTimeMs);
+  int nMaxMs(m_nTimeMs);
+  this->moveTime(&nTargetMs, &nMaxMs);
+  m_nMoveNo++;
+  emit startSearch(state, History(), nTargetMs, nMaxMs, m_nMoveNo);
+}
+
+void OpponentMcts::receivedMove(const Move &move, const quint32 nMoveNo) {
+  if (nMoveNo != m_nMoveNo) {
+    return;
+  }
+  if (!move.isValid()) {
+    qCritical() << "CPU" << m_nID << "found no move!";
+    emit scriptError("No move found", m_nID);
+    return;
+  }
+  emit madeMove(move);
+}
@@ -0,0 +1,90 @@
+/**
+ * \file opponentmcts.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the Monte Carlo tree search CPU opponent.
+ */
+
+#ifndef OPPONENTMCTS_H_
+#define OPPONENTMCTS_H_
+
+#include "./enginerunner.h"
+#include "./opponent.h"
+#include "./mcts.h"
+
+/**
+ * \class MctsRunner
+ * \brief Search tree of an OpponentMcts, in the worker thread.
+ */
+class MctsRunner : public EngineRunner {
+  Q_OBJECT
+
+  public:
+    MctsRunner(const quint8 nID, const quint8 nThreads, const quint64 nSeed);
+
+  protected:
+    Move think(const GameState &state, const History &history,
+               const int nTargetMs, const int nMaxMs);
+    void interrupt();
+
+  private:
+    const quint8 m_nID;
+    Mcts m_Mcts;
+};
+
+// ---------------------------------------------------------------------------
+
+/**
+ * \class OpponentMcts
+ * \brief CPU opponent using the built-in Monte Carlo tree search.
+ *
+ * The search runs in the thread of a MctsRunner.
+ */
+class OpponentMcts : public Opponent {
+  Q_OBJECT
+
+  public:
+    OpponentMcts(const quint8 nID, const int nTimeMs, const quint8 nThreads,
+                 const quint64 nSeed, QObject *pParent = 0);
+    ~OpponentMcts();
+    bool initCpu(const QString &sCpu);
+
+  public slots:
+    void makeMoveCpu(const GameState &state);
+
+  signals:
+    void startSearch(const GameState &state, const History &history,
+                     const int nTargetMs, const int nMaxMs,
+                     const quint32 nMoveNo);
+
+  private slots:
+    void receivedMove(const Move &move, const quint32 nMoveNo);
+
+  private:
+    Q_DISABLE_COPY(OpponentMcts)
+
+    const int m_nTimeMs;  // Per move, without game clock
+    MctsRunner *m_pRunner;
+    quint32 m_nMoveNo;
+};
+
+#endif  // OPPONENTMCTS_H_
@@ -0,0 +1,144 @@
+/**
+ * \file opponentnative.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Native CPU opponent.
+ */
+
+#include <QDebug>
+
+#include "./opponentnative.h"
+
+NativeRunner::NativeRunner(const quint8 nID, const quint8 nMaxDepth,
+                           const quint8 nThreads, const quint32 nHashSizeMB,
+                           const quint8 nReplacement,
+                           const Tablebase *pTablebase)
+  : m_nID(nID),
+    m_nMaxDepth(nMaxDepth),
+    m_Table(nHashSizeMB, static_cast<TranspositionTable::Replacement>(
+              qMin(nReplacement,
+                   static_cast<quint8>(TranspositionTable::ReplaceDepthAge)))) {
+  m_Search.setTable(&m_Table);
+  m_Search.setTablebase(pTablebase);
+  m_Search.setThreads(nThreads);
+}
+
+Move NativeRunner::think(const GameState &state, const History &history,
+                         const int nTargetMs, const int nMaxMs) {
+  m_Search.setLimits(m_nMaxDepth, nMaxMs, nTargetMs);
+  m_Search.setHistory(history);
+  const Move move(m_Search.findBestMove(state));
+  if (move.isValid()) {
+    qDebug() << "CPU" << m_nID << "move:" << state.moveToString(move)
+             << "- depth:" << m_Search.getDepth()
+             << "nodes:" << m_Search.getNodes()
+             << "threads:" << m_Search.getThreads()
+             << "score:" << m_Search.getScore()
+             << "hash usage:" << m_Table.usage() << "permill";
+  }
+  return move;
+}
+
+void NativeRunner::interrupt() {
+  m_Search.stop();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+OpponentNative::OpponentNative(const quint8 nID, const quint8 nMaxDepth,
+                               const int nTimeMs, const quint8 nThreads,
+                               const quint32 nHashSizeMB,
+                               const quint8 nReplacement,
+                               const Tablebase *pTablebase, QObject *pParent)
+  : Opponent(nID, pParent),
+    m_nTimeMs(nTimeMs),
+    m_pRunner(new NativeRunner(nID, nMaxDepth, nThreads, nHashSizeMB,
+                               nReplacement, pTablebase)),
+    m_nMoveNo(0) {
+  connect(this, SIGNAL(startSearch(GameState, History, int, int, quint32)),
+          m_pRunner, SLOT(makeMove(GameState, History, int, int, quint32)));
+  connect(m_pRunner, SIGNAL(madeMove(Move, quint32)),
+          this, SLOT(receivedMove(Move, quint32)));
+  m_pRunner->start();
+}
+
+// A running search is stopped
+OpponentNative::~OpponentNative() {
+  m_pRunner->finish();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool OpponentNative::initCpu(const QString &sCpu) {
+  qDebug() << "CPU" << m_nID << "engine:" << sCpu;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void OpponentNative::makeMoveCpu(const GameState &state) {
+  if (m_History.isEmpty() || m_Game.getKey() != state.getKey()) {
+    // A pass is not reported by moveApplied()
+    m_Game.passTurn();
+    if (m_History.isEmpty() || m_Game.getKey() != state.getKey()) {
+      m_History.clear();  // E.g. loaded game, history starts here
+    }
+    m_Game = state;
+    m_History.push(state.getKey());
+  }
+  if (this->playBookMove(state)) {
+    return;
+  }
+  int nTargetMs(0);
+  int nMaxMs(m_nTimeMs);
+  this->moveTime(&nTargetMs, &nMaxMs);
+  m_nMoveNo++;
+  emit startSearch(state, m_History, nTargetMs, nMaxMs, m_nMoveNo);
+}
+
+void OpponentNative::receivedMove(const Move &move, const quint32 nMoveNo) {
+  if (nMoveNo != m_nMoveNo) {
+    return;
+  }
+  if (!move.isValid()) {
+    qCritical() << "CPU" << m_nID << "found no move!";
+    emit scriptError("No move found", m_nID);
+    return;
+  }
+  emit madeMove(move);
+}
+
+// ---------------------------------------------------------------------------
+
+// Both players' moves, the positions are remembered for the search
+void OpponentNative::moveApplied(const Move &move, const quint8 nPlayer) {
+  if (m_History.isEmpty() || nPlayer != m_Game.getCurrentPlayer() ||
+      GameState::MoveOk != m_Game.checkMove(move)) {
+    m_History.clear();  // Out of sync, restarted by the next makeMoveCpu()
+    return;
+  }
+  m_Game.applyMove(move);
+  m_History.push(m_Game.getKey());
+}
@@ -0,0 +1,101 @@
+/**
+ * \file opponentnative.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the native CPU opponent.
+ */
+
+#ifndef OPPONENTNATIVE_H_
+#define OPPONENTNATIVE_H_
+
+#include "./enginerunner.h"
+#include "./opponent.h"
+#include "./search.h"
+
+/**
+ * \class NativeRunner
+ * \brief Alpha-beta search and transposition table of an OpponentNative,
+ *        in the worker thread.
+ */
+class NativeRunner : public EngineRunner {
+  Q_OBJECT
+
+  public:
+    NativeRunner(const quint8 nID, const quint8 nMaxDepth,
+                 const quint8 nThreads, const quint32 nHashSizeMB,
+                 const quint8 nReplacement, const Tablebase *pTablebase);
+
+  protected:
+    Move think(const GameState &state, const History &history,
+               const int nTargetMs, const int nMaxMs);
+    void interrupt();
+
+  private:
+    const quint8 m_nID;
+    const quint8 m_nMaxDepth;
+    TranspositionTable m_Table;
+    Search m_Search;
+};
+
+// ---------------------------------------------------------------------------
+
+/**
+ * \class OpponentNative
+ * \brief CPU opponent using the built-in alpha-beta search.
+ *
+ * The search runs in the thread of a NativeRunner, the game history is
+ * kept here and passed with each move.
+ */
+class OpponentNative : public Opponent {
+  Q_OBJECT
+
+  public:
+    OpponentNative(const quint8 nID, const quint8 nMaxDepth,
+                   const int nTimeMs, const quint8 nThreads,
+                   const quint32 nHashSizeMB, const quint8 nReplacement,
+                   const Tablebase *pTablebase, QObject *pParent = 0);
+    ~OpponentNative();
+    bool initCpu(const QString &sCpu);
+
+  public slots:
+    void makeMoveCpu(const GameState &state);
+    void moveApplied(const Move &move, const quint8 nPlayer);
+
+  signals:
+    void startSearch(const GameState &state, const History &history,
+                     const int nTargetMs, const int nMaxMs,
+                     const quint32 nMoveNo);
+
+  private slots:
+    void receivedMove(const Move &move, const quint32 nMoveNo);
+
+  private:
+    Q_DISABLE_COPY(OpponentNative)
+
+    const int m_nTimeMs;  // Per move, without game clock
+    NativeRunner *m_pRunner;
+    quint32 m_nMoveNo;
+    GameState m_Game;    // Position after the last applied move
+    History m_History;   // For repetitions in the search
+};
+
+#endif  // OPPONENTNATIVE_H_
@@ -0,0 +1,118 @@
+/**
+ * \file perft.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Move generator node count (perft).
+ */
+
+#include <QElapsedTimer>
+
+#include "./perft.h"
+
+Perft::Perft(const GameState &state)
+  : m_State(state) {
+  for (int i = 0; i <= MaxDepth; i++) {
+    m_Moves[i].reserve(128);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Node count per root move, followed by total, time and nodes per second
+quint64 Perft::divide(const quint8 nDepth, QTextStream *pOut) {
+  const quint8 nMaxDepth(qBound(1, static_cast<int>(nDepth),
+                                static_cast<int>(MaxDepth)));
+  QElapsedTimer timer;
+  timer.start();
+
+  QVector<Move> rootMoves;
+  quint64 nNodes(0);
+  if (0 == m_State.getWinner()) {
+    m_State.generateMoves(&rootMoves);
+  }
+
+  if (rootMoves.isEmpty()) {
+    nNodes = this->count(nMaxDepth);
+    if (0 != nNodes) {
+      *pOut << "pass: " << nNodes << endl;
+    }
+  } else {
+    GameState::Undo undo;
+    foreach (const Move &move, rootMoves) {
+      m_State.applyMove(move, &undo);
+      const quint64 nMoveNodes(this->count(nMaxDepth - 1));
+      m_State.undoMove(move, undo);
+      *pOut << m_State.moveToString(move) << ": " << nMoveNodes << endl;
+      nNodes += nMoveNodes;
+    }
+  }
+
+  const qint64 nElapsed(timer.elapsed());
+  *pOut << endl
+        << "Depth: " << static_cast<int>(nMaxDepth) << endl
+        << "Moves: " << rootMoves.size() << endl
+        << "Nodes: " << nNodes << endl
+        << "Time: " << nElapsed << " ms" << endl
+        << "Nodes/s: " << nNodes * 1000 / qMax(Q_INT64_C(1), nElapsed)
+        << endl;
+  return nNodes;
+}
+
+// ---------------------------------------------------------------------------
+
+quint64 Perft::count(const quint8 nDepth) {
+  if (0 == nDepth) {
+    return 1;
+  }
+  if (0 != m_State.getWinner()) {
+    return 0;
+  }
+
+  QVector<Move> &moves(m_Moves[nDepth]);
+  m_State.generateMoves(&moves);
+  if (moves.isEmpty()) {
+    // Pass, if the opponent still can move (as Game::checkPossibleMoves)
+    quint64 nNodes(0);
+    m_State.passTurn();
+    m_State.generateMoves(&moves);
+    if (!moves.isEmpty()) {
+      nNodes = this->count(nDepth - 1);
+    }
+    m_State.passTurn();
+    return nNodes;
+  }
+
+  // Leaves do not have to be applied
+  if (1 == nDepth) {
+    return moves.size();
+  }
+
+  quint64 nNodes(0);
+  GameState::Undo undo;
+  for (int i = 0; i < moves.size(); i++) {
+    m_State.applyMove(moves[i], &undo);
+    nNodes += this->count(nDepth - 1);
+    m_State.undoMove(moves[i], undo);
+  }
+  return nNodes;
+}
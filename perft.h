@@ -0,0 +1,56 @@
+/**
+ * \file perft.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the move generator node count (perft).
+ */
+
+#ifndef PERFT_H_
+#define PERFT_H_
+
+#include <QTextStream>
+#include <QVector>
+
+#include "./gamestate.h"
+
+/**
+ * \class Perft
+ * \brief Counts all leaf nodes of the game tree up to a fixed depth.
+ *
+ * Used to benchmark and regression test the move generator. A pass (no
+ * own move, but the opponent can move) counts as one move, positions with
+ * a winner or without moves for both players have no successors.
+ */
+class Perft {
+  public:
+    enum { MaxDepth = 32 };
+
+    explicit Perft(const GameState &state);
+    quint64 divide(const quint8 nDepth, QTextStream *pOut);
+    quint64 count(const quint8 nDepth);
+
+  private:
+    GameState m_State;
+    QVector<Move> m_Moves[MaxDepth + 1];
+};
+
+#endif  // PERFT_H_
@@ -25,18 +25,12 @@
  */
 
 #include <QDebug>
-#include <QMessageBox>
 
 #include "./player.h"
 
-Player::Player(bool bActive, bool bIsHuman, QString sName, quint8 nMaxStones)
-  : m_bIsActive(bActive),
-    m_bIsHuman(bIsHuman),
-    m_sName(sName),
-    m_nMaxStones(nMaxStones),
-    m_nStonesLeft(nMaxStones),
-    m_nWonTowers(0),
-    m_nCanMove(0) {
+Player::Player(bool bIsHuman, QString sName)
+  : m_bIsHuman(bIsHuman),
+    m_sName(sName) {
   if (!m_bIsHuman) {
     m_sName = "Computer";
   }
@@ -49,17 +43,6 @@ Player::~Player() {
 // ---------------------------------------------------------------------------
 // ---------------------------------------------------------------------------
 
-void Player::setActive(const bool bActive) {
-  m_bIsActive = bActive;
-}
-
-bool Player::getIsActive() const {
-  return m_bIsActive;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
 bool Player::getIsHuman() const {
   return m_bIsHuman;
 }
@@ -67,41 +50,3 @@ bool Player::getIsHuman() const {
 QString Player::getName() const {
   return m_sName;
 }
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-void Player::setCanMove(const quint8 nCanMove) {
-  m_nCanMove = nCanMove;
-}
-
-quint8 Player::getCanMove() const {
-  return m_nCanMove;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-void Player::setStonesLeft(const quint8 nStones) {
-  if (nStones <= m_nMaxStones) {
-    m_nStonesLeft = nStones;
-  } else {
-    m_nStonesLeft = m_nMaxStones;
-    qWarning() << "Stones > MaxStones!" << nStones << ">" << m_nMaxStones;
-    QMessageBox::warning(NULL, "Warning", "Something went wrong!");
-  }
-}
-
-quint8 Player::getStonesLeft() const {
-  return m_nStonesLeft;
-}
-
-// ---------------------------------------------------------------------------
-// ---------------------------------------------------------------------------
-
-void Player::setWonTowers(const quint8 nWonTowers) {
-  m_nWonTowers = nWonTowers;
-}
-
-quint8 Player::getWonTowers() const {
-  return m_nWonTowers;
-}
@@ -31,32 +31,19 @@
 
 /**
  * \class Player
- * \brief Player class.
+ * \brief Player class (stones, won towers etc. are part of GameState).
  */
 class Player {
   public:
-    Player(bool bActive, bool bIsHuman, QString sName, quint8 nMaxStones);
+    Player(bool bIsHuman, QString sName);
     ~Player();
 
-    void setActive(const bool bActive);
-    bool getIsActive() const;
     bool getIsHuman() const;
     QString getName() const;
-    void setStonesLeft(const quint8 nStones);
-    quint8 getStonesLeft() const;
-    void setWonTowers(const quint8 nWonTowers);
-    quint8 getWonTowers() const;
-    void setCanMove(const quint8 nCanMove);
-    quint8 getCanMove() const;
 
   private:
-    bool m_bIsActive;
     const bool m_bIsHuman;
     QString m_sName;
-    const quint8 m_nMaxStones;
-    quint8 m_nStonesLeft;
-    quint8 m_nWonTowers;
-    quint8 m_nCanMove;
 };
 
 #endif  // PLAYER_H_
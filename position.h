@@ -0,0 +1,181 @@
+/**
+ * \file position.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Packed board position (bit masks) and move definition.
+ */
+
+#ifndef POSITION_H_
+#define POSITION_H_
+
+#include <QMetaType>
+#include <QtGlobal>
+
+#include "./zobrist.h"
+
+/**
+ * \struct Move
+ * \brief A single move: set a stone (nFrom = -1) or move nStones from
+ *        field nFrom onto field nTo. Fields are indices (y * size + x).
+ */
+struct Move {
+  Move() : nFrom(-1), nTo(-1), nStones(0) {}
+  Move(const qint8 from, const qint8 to, const quint8 stones)
+    : nFrom(from), nTo(to), nStones(stones) {}
+
+  bool isValid() const { return nTo >= 0; }
+  bool isSetStone() const { return nFrom < 0 && nTo >= 0; }
+  bool operator==(const Move &other) const {
+    return nFrom == other.nFrom && nTo == other.nTo &&
+        nStones == other.nStones;
+  }
+  bool operator!=(const Move &other) const { return !(*this == other); }
+
+  qint8 nFrom;
+  qint8 nTo;
+  quint8 nStones;
+};
+Q_DECLARE_METATYPE(Move)
+
+/**
+ * \class Position
+ * \brief Fixed size packed position: one bit per field in 32 bit masks.
+ *
+ * A tower never stays on the board with MaxLevels + 1 stones (it is
+ * conquered immediately), so each field is described by a 3 bit height
+ * (three height planes) and one colour bit per level (bit set = stone of
+ * player 2). Copying a position costs a few machine words only.
+ * The Zobrist key is updated incrementally by all setters.
+ */
+class Position {
+  public:
+    enum { MaxFields = 32, MaxLevels = 4 };
+
+    Position()
+      : m_nOccupied(0),
+        m_nCurrentPlayer(1),
+        m_nKey(0) {
+      for (int i = 0; i < 3; i++) {
+        m_nHeight[i] = 0;
+      }
+      for (int i = 0; i < MaxLevels; i++) {
+        m_nColor[i] = 0;
+      }
+      m_nStonesLeft[0] = m_nStonesLeft[1] = 0;
+      m_nWonTowers[0] = m_nWonTowers[1] = 0;
+    }
+
+    quint32 occupied() const { return m_nOccupied; }
+    bool isOccupied(const qint8 nField) const {
+      return (m_nOccupied >> nField) & 1;
+    }
+
+    quint8 height(const qint8 nField) const {
+      return ((m_nHeight[0] >> nField) & 1) |
+          (((m_nHeight[1] >> nField) & 1) << 1) |
+          (((m_nHeight[2] >> nField) & 1) << 2);
+    }
+
+    // Bit i set = stone on level i (0 = bottom) belongs to player 2
+    quint8 colors(const qint8 nField) const {
+      quint8 nColors(0);
+      for (int i = 0; i < MaxLevels; i++) {
+        nColors |= ((m_nColor[i] >> nField) & 1) << i;
+      }
+      return nColors;
+    }
+
+    quint8 stone(const qint8 nField, const quint8 nLevel) const {
+      return ((m_nColor[nLevel] >> nField) & 1) ? 2 : 1;
+    }
+
+    quint8 topStone(const qint8 nField) const {
+      const quint8 nHeight(this->height(nField));
+      return (0 == nHeight) ? 0 : this->stone(nField, nHeight - 1);
+    }
+
+    void setTower(const qint8 nField, const quint8 nHeight,
+                  const quint8 nColors) {
+      Q_ASSERT(nHeight <= MaxLevels);
+      m_nKey ^= Zobrist::tower(nField, this->height(nField),
+                               this->colors(nField)) ^
+          Zobrist::tower(nField, nHeight, nColors);
+      const quint32 nBit(1u << nField);
+      for (int i = 0; i < 3; i++) {
+        m_nHeight[i] = (m_nHeight[i] & ~nBit) |
+            ((static_cast<quint32>(nHeight >> i) & 1) << nField);
+      }
+      for (int i = 0; i < MaxLevels; i++) {
+        // Keep unused levels cleared, positions can be compared bitwise
+        const quint32 nSet((i < nHeight) ? ((nColors >> i) & 1) : 0);
+        m_nColor[i] = (m_nColor[i] & ~nBit) | (nSet << nField);
+      }
+      m_nOccupied = (0 == nHeight) ? (m_nOccupied & ~nBit)
+                                   : (m_nOccupied | nBit);
+    }
+
+    quint8 currentPlayer() const { return m_nCurrentPlayer; }
+    void setCurrentPlayer(const quint8 nPlayer) {
+      if (nPlayer != m_nCurrentPlayer) {
+        m_nKey ^= Zobrist::side();
+        m_nCurrentPlayer = nPlayer;
+      }
+    }
+    quint8 stonesLeft(const quint8 nPlayer) const {
+      return m_nStonesLeft[nPlayer - 1];
+    }
+    void setStonesLeft(const quint8 nPlayer, const quint8 nStones) {
+      m_nKey ^= Zobrist::stonesLeft(nPlayer, m_nStonesLeft[nPlayer - 1]) ^
+          Zobrist::stonesLeft(nPlayer, nStones);
+      m_nStonesLeft[nPlayer - 1] = nStones;
+    }
+    quint8 wonTowers(const quint8 nPlayer) const {
+      return m_nWonTowers[nPlayer - 1];
+    }
+    void setWonTowers(const quint8 nPlayer, const quint8 nWon) {
+      m_nKey ^= Zobrist::wonTowers(nPlayer, m_nWonTowers[nPlayer - 1]) ^
+          Zobrist::wonTowers(nPlayer, nWon);
+      m_nWonTowers[nPlayer - 1] = nWon;
+    }
+    Move previousMove() const { return m_PreviousMove; }
+    void setPreviousMove(const Move &move) {
+      m_nKey ^= Zobrist::previousMove(m_PreviousMove.nFrom, m_PreviousMove.nTo,
+                                      m_PreviousMove.nStones) ^
+          Zobrist::previousMove(move.nFrom, move.nTo, move.nStones);
+      m_PreviousMove = move;
+    }
+
+    // Zobrist key, identical for equal positions
+    quint64 key() const { return m_nKey; }
+
+  private:
+    quint32 m_nOccupied;
+    quint32 m_nHeight[3];
+    quint32 m_nColor[MaxLevels];
+    quint8 m_nStonesLeft[2];
+    quint8 m_nWonTowers[2];
+    quint8 m_nCurrentPlayer;
+    Move m_PreviousMove;
+    quint64 m_nKey;
+};
+
+#endif  // POSITION_H_
@@ -0,0 +1,67 @@
+/**
+ * \file random.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Seeded random number generator.
+ */
+
+#include <QDateTime>
+
+#include "./random.h"
+
+Random::Random(const quint64 nSeed)
+  : m_nState(nSeed) {
+}
+
+void Random::seed(const quint64 nSeed) {
+  m_nState = nSeed;
+}
+
+// ---------------------------------------------------------------------------
+
+quint64 Random::next() {
+  quint64 z(m_nState += Q_UINT64_C(0x9E3779B97F4A7C15));
+  z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+  return z ^ (z >> 31);
+}
+
+// 0 <= result < nMax
+quint32 Random::bounded(const quint32 nMax) {
+  if (0 == nMax) {
+    return 0;
+  }
+  return static_cast<quint32>(this->next() % nMax);
+}
+
+// 0 <= result < 1, same as Math.random()
+double Random::real() {
+  return (this->next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ---------------------------------------------------------------------------
+
+// Seed for runs without --seed; printed, so the run can be repeated
+quint64 Random::timeSeed() {
+  Random random(static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()));
+  return random.next() >> 33;  // Small enough for the command line (int)
+}
@@ -0,0 +1,53 @@
+/**
+ * \file random.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the seeded random number generator.
+ */
+
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <QtGlobal>
+
+/**
+ * \class Random
+ * \brief Small seeded random number generator (splitmix64).
+ *
+ * Used instead of qrand() wherever a game has to be reproducible: start
+ * player, CPU scripts and MCTS playouts get their seeds from the game seed.
+ */
+class Random {
+  public:
+    explicit Random(const quint64 nSeed = 0);
+
+    void seed(const quint64 nSeed);
+    quint64 next();
+    quint32 bounded(const quint32 nMax);
+    double real();
+    static quint64 timeSeed();
+
+  private:
+    quint64 m_nState;
+};
+
+#endif  // RANDOM_H_
@@ -0,0 +1,263 @@
+/**
+ * \file retrograde.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Tablebase generator (retrograde analysis of endgames).
+ */
+
+#include <QDebug>
+
+#include "./retrograde.h"
+
+Retrograde::Retrograde(const GameState &rules, const quint8 nDepth,
+                       const quint64 nSeed)
+  : m_Rules(rules),
+    m_nDepth(qBound(quint8(1), nDepth, static_cast<quint8>(MaxDepth))),
+    m_Random(nSeed) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Random games, but an immediate conquest is always played. The positions
+// of the last plies before the end are the roots of the game graph.
+void Retrograde::addEndgames(const int nGames) {
+  QVector<Move> moves;
+  QVector<GameState> history;
+  GameState::Undo undo;
+
+  for (int nGame = 0; nGame < nGames; nGame++) {
+    GameState state(m_Rules);
+    state.setCurrentPlayer(m_Random.bounded(2) + 1);
+    history.clear();
+
+    while (0 == state.getWinner() && history.size() < MaxGamePlies) {
+      state.generateMoves(&moves);
+      if (moves.isEmpty()) {
+        GameState passed(state);
+        passed.passTurn();
+        passed.generateMoves(&moves);
+        if (moves.isEmpty()) {
+          break;  // Tie
+        }
+        history.append(state);
+        state = passed;
+        continue;
+      }
+
+      const quint8 nPlayer(state.getCurrentPlayer());
+      Move move(moves[m_Random.bounded(moves.size())]);
+      foreach (const Move &m, moves) {
+        state.applyMove(m, &undo);
+        const bool bWin(nPlayer == state.getWinner());
+        state.undoMove(m, undo);
+        if (bWin) {
+          move = m;
+          break;
+        }
+      }
+      history.append(state);
+      state.applyMove(move);
+    }
+
+    for (int i = qMax(0, history.size() - RootPlies); i < history.size(); i++) {
+      m_Roots.append(history[i]);
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+// Breadth first, so each node is expanded at its smallest distance to a root
+void Retrograde::expand() {
+  QVector<GameState> frontier;
+  foreach (const GameState &root, m_Roots) {
+    this->addNode(root, &frontier);
+  }
+
+  for (int nPly = 0; nPly < m_nDepth && !frontier.isEmpty(); nPly++) {
+    QVector<GameState> next;
+    foreach (const GameState &state, frontier) {
+      // Children of the last ply are only checked for a winner
+      this->expandNode(state, (nPly + 1 < m_nDepth) ? &next : NULL);
+    }
+    frontier = next;
+    qDebug() << "Retrograde ply" << nPly + 1 << "- nodes:" << m_Nodes.size();
+  }
+}
+
+// Returns the index of the node or -1, if the graph is full
+int Retrograde::addNode(const GameState &state, QVector<GameState> *pFrontier) {
+  // Symmetric positions are one node
+  const quint64 nKey(state.getCanonicalKey());
+  QHash<quint64, int>::const_iterator it(m_Index.constFind(nKey));
+  if (m_Index.constEnd() != it) {
+    return it.value();
+  }
+  if (m_Nodes.size() >= MaxNodes) {
+    return -1;
+  }
+
+  const int nNode(m_Nodes.size());
+  m_Nodes.append(Node());
+  m_Nodes[nNode].nKey = nKey;
+  m_Index.insert(nKey, nNode);
+
+  const quint8 nWinner(state.getWinner());
+  if (0 != nWinner) {
+    m_Nodes[nNode].bTerminal = true;
+    this->resolve(nNode, nWinner == state.getCurrentPlayer()
+                  ? Tablebase::Win : Tablebase::Loss, 0);
+  } else if (NULL != pFrontier) {
+    pFrontier->append(state);
+  }
+  return nNode;
+}
+
+void Retrograde::expandNode(const GameState &state, QVector<GameState> *pNext) {
+  const int nParent(m_Index.value(state.getCanonicalKey(), -1));
+  if (-1 == nParent || m_Nodes[nParent].bExpanded ||
+      Tablebase::Unknown != m_Nodes[nParent].value) {
+    return;
+  }
+
+  QVector<Move> moves;
+  QVector<GameState> children;
+  state.generateMoves(&moves);
+  if (moves.isEmpty()) {
+    GameState passed(state);
+    passed.passTurn();
+    passed.generateMoves(&moves);
+    if (moves.isEmpty()) {  // Tie, nobody can move
+      m_Nodes[nParent].bTerminal = true;
+      this->resolve(nParent, Tablebase::Draw, 0);
+      return;
+    }
+    children.append(passed);
+  } else {
+    foreach (const Move &move, moves) {
+      children.append(state);
+      children.last().applyMove(move);
+    }
+  }
+
+  bool bComplete(true);
+  foreach (const GameState &child, children) {
+    const int nChild(this->addNode(child, pNext));
+    if (-1 == nChild) {
+      bComplete = false;
+      continue;
+    }
+    m_EdgeChild.append(nChild);
+    m_EdgeParent.append(nParent);
+    m_Nodes[nParent].nOpen++;
+  }
+  m_Nodes[nParent].bExpanded = bComplete;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Retrograde::resolve(const int nNode, const Tablebase::Value value,
+                         const quint16 nDistance) {
+  m_Nodes[nNode].value = value;
+  m_Nodes[nNode].nDistance = nDistance;
+  m_Queue.append(nNode);
+}
+
+// The queue is processed in the order of the distance, so a win is found
+// with the shortest and a loss with the longest distance
+void Retrograde::solve() {
+  // Parents of each node (compressed rows)
+  QVector<qint32> start(m_Nodes.size() + 1, 0);
+  foreach (const qint32 nChild, m_EdgeChild) {
+    start[nChild + 1]++;
+  }
+  for (int i = 0; i < m_Nodes.size(); i++) {
+    start[i + 1] += start[i];
+  }
+  QVector<qint32> parents(m_EdgeParent.size());
+  QVector<qint32> fill(start);
+  for (int i = 0; i < m_EdgeChild.size(); i++) {
+    parents[fill[m_EdgeChild[i]]++] = m_EdgeParent[i];
+  }
+  m_EdgeChild.clear();
+  m_EdgeParent.clear();
+
+  for (int i = 0; i < m_Queue.size(); i++) {
+    const Node child(m_Nodes[m_Queue[i]]);
+    for (int n = start[m_Queue[i]]; n < start[m_Queue[i] + 1]; n++) {
+      Node &parent(m_Nodes[parents[n]]);
+      if (Tablebase::Unknown != parent.value) {
+        continue;
+      }
+      if (Tablebase::Loss == child.value) {
+        this->resolve(parents[n], Tablebase::Win, child.nDistance + 1);
+        continue;
+      }
+      parent.nOpen--;
+      if (Tablebase::Draw == child.value) {
+        parent.bDraw = true;
+      } else {
+        parent.nMaxWin = qMax(parent.nMaxWin, child.nDistance);
+      }
+      if (0 == parent.nOpen && parent.bExpanded) {
+        if (parent.bDraw) {
+          this->resolve(parents[n], Tablebase::Draw, 0);
+        } else {
+          this->resolve(parents[n], Tablebase::Loss, parent.nMaxWin + 1);
+        }
+      }
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+// Terminal positions are recognized by the search itself
+bool Retrograde::write(const QString &sFile) const {
+  QVector<Tablebase::Entry> entries;
+  foreach (const Node &node, m_Nodes) {
+    if (Tablebase::Unknown != node.value && !node.bTerminal) {
+      entries.append(Tablebase::Entry(node.nKey, node.value, node.nDistance));
+    }
+  }
+  return Tablebase::write(sFile, m_Rules, &entries);
+}
+
+int Retrograde::getRoots() const {
+  return m_Roots.size();
+}
+
+int Retrograde::getNodes() const {
+  return m_Nodes.size();
+}
+
+int Retrograde::getSolved(const Tablebase::Value value) const {
+  int nCount(0);
+  foreach (const Node &node, m_Nodes) {
+    if (value == node.value && !node.bTerminal) {
+      nCount++;
+    }
+  }
+  return nCount;
+}
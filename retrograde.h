@@ -0,0 +1,104 @@
+/**
+ * \file retrograde.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the tablebase generator.
+ */
+
+#ifndef RETROGRADE_H_
+#define RETROGRADE_H_
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "./gamestate.h"
+#include "./random.h"
+#include "./tablebase.h"
+
+/**
+ * \class Retrograde
+ * \brief Generates a Tablebase by retrograde analysis.
+ *
+ * The complete game is far too big to be solved (40 stones, which never
+ * leave the game), so the analysis works on endgame positions: the last
+ * plies of self-play games are expanded to a full game graph of nDepth
+ * plies. Starting from the conquered towers, results are propagated back
+ * to the predecessors; a position is solved exactly, if one move leads to
+ * a lost position or all moves lead to won positions of the opponent.
+ * Positions depending on the unexpanded border of the graph stay Unknown.
+ * Symmetric positions (rotated / mirrored board) share one node.
+ */
+class Retrograde {
+  public:
+    enum { MaxDepth = 6, MaxNodes = 4000000, MaxGamePlies = 500,
+           RootPlies = 4 };
+
+    Retrograde(const GameState &rules, const quint8 nDepth,
+               const quint64 nSeed);
+    void addEndgames(const int nGames);
+    void expand();
+    void solve();
+    bool write(const QString &sFile) const;
+
+    int getRoots() const;
+    int getNodes() const;
+    int getSolved(const Tablebase::Value value) const;
+
+  private:
+    /**
+     * \struct Node
+     * \brief Position of the game graph.
+     */
+    struct Node {
+      Node()
+        : nKey(0), nOpen(0), nDistance(0), nMaxWin(0),
+          value(Tablebase::Unknown), bExpanded(false), bTerminal(false),
+          bDraw(false) {}
+
+      quint64 nKey;
+      quint16 nOpen;      // Children, which are not solved yet
+      quint16 nDistance;  // Plies to the end of the game
+      quint16 nMaxWin;    // Longest win of the opponent after a move
+      Tablebase::Value value;
+      bool bExpanded;     // All children are part of the graph
+      bool bTerminal;
+      bool bDraw;         // One of the children is a draw
+    };
+
+    int addNode(const GameState &state, QVector<GameState> *pFrontier);
+    void expandNode(const GameState &state, QVector<GameState> *pNext);
+    void resolve(const int nNode, const Tablebase::Value value,
+                 const quint16 nDistance);
+
+    GameState m_Rules;
+    const quint8 m_nDepth;
+    Random m_Random;
+    QVector<GameState> m_Roots;
+    QHash<quint64, int> m_Index;
+    QVector<Node> m_Nodes;
+    QVector<qint32> m_EdgeChild;
+    QVector<qint32> m_EdgeParent;
+    QVector<qint32> m_Queue;  // Solved nodes in the order of distance
+};
+
+#endif  // RETROGRADE_H_
@@ -0,0 +1,181 @@
+/**
+ * \file scriptpool.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Pool of loaded CPU script engines.
+ */
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "./scriptpool.h"
+#include "./scriptrunner.h"
+
+ScriptPool *ScriptPool::m_pInstance = NULL;
+QMutex ScriptPool::m_InstanceMutex;
+
+ScriptPool::ScriptPool() {
+}
+
+// Idle runners end at once, waiting lets them delete their engine before
+// the application is gone
+ScriptPool::~ScriptPool() {
+  foreach (const Entry &entry, m_Idle) {
+    QThread *pThread(entry.pRunner->thread());
+    destroyRunner(entry.pRunner);
+    pThread->wait(2000);
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+ScriptPool *ScriptPool::instance() {
+  QMutexLocker locker(&m_InstanceMutex);
+  if (NULL == m_pInstance) {
+    m_pInstance = new ScriptPool();
+    qAddPostRoutine(ScriptPool::deleteInstance);
+  }
+  return m_pInstance;
+}
+
+void ScriptPool::deleteInstance() {
+  QMutexLocker locker(&m_InstanceMutex);
+  delete m_pInstance;
+  m_pInstance = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Returns an idle runner for the script if available, otherwise a new one.
+// Either way the caller has to call load() of the runner.
+ScriptRunner *ScriptPool::acquire(const QString &sFilepath,
+                                  const quint8 nNumOfFields,
+                                  const quint8 nHeightTowerWin) {
+  const QDateTime modified(QFileInfo(sFilepath).lastModified());
+  QList<ScriptRunner *> outdated;
+  ScriptRunner *pRunner(NULL);
+  {
+    QMutexLocker locker(&m_Mutex);
+    for (int i = 0; i < m_Idle.size() && NULL == pRunner; i++) {
+      const Entry &entry(m_Idle[i]);
+      if (entry.sFilepath != sFilepath ||
+          entry.nNumOfFields != nNumOfFields ||
+          entry.nHeightTowerWin != nHeightTowerWin) {
+        continue;
+      }
+      if (entry.modified != modified) {  // Script was changed meanwhile
+        outdated << m_Idle.takeAt(i).pRunner;
+        i--;
+        continue;
+      }
+      const Entry found(m_Idle.takeAt(i));
+      m_InUse.insert(found.pRunner, found);
+      pRunner = found.pRunner;
+    }
+
+    if (NULL == pRunner) {
+      Entry entry;
+      entry.sFilepath = sFilepath;
+      entry.modified = modified;
+      entry.nNumOfFields = nNumOfFields;
+      entry.nHeightTowerWin = nHeightTowerWin;
+      entry.pRunner = createRunner(nNumOfFields, nHeightTowerWin);
+      m_InUse.insert(entry.pRunner, entry);
+      pRunner = entry.pRunner;
+    }
+  }
+
+  // Outside of the lock, they don't belong to the pool anymore
+  foreach (ScriptRunner *pOutdated, outdated) {
+    destroyRunner(pOutdated);
+  }
+  return pRunner;
+}
+
+// ---------------------------------------------------------------------------
+
+// Runners, which were interrupted or reported an error, are not reused
+void ScriptPool::release(ScriptRunner *pRunner, const bool bReusable) {
+  {
+    QMutexLocker locker(&m_Mutex);
+    const Entry entry(m_InUse.take(pRunner));
+    if (bReusable && m_Idle.size() < MaxIdle && NULL != entry.pRunner &&
+        entry.modified == QFileInfo(entry.sFilepath).lastModified()) {
+      m_Idle.append(entry);
+      return;
+    }
+  }
+  destroyRunner(pRunner);  // Outside of the lock, see acquire()
+}
+
+// ---------------------------------------------------------------------------
+
+// Loads the script into nCount new runners in the background, e.g. before
+// a tournament
+void ScriptPool::warmUp(const QString &sFilepath, const quint8 nNumOfFields,
+                        const quint8 nHeightTowerWin, const int nCount) {
+  const QDateTime modified(QFileInfo(sFilepath).lastModified());
+  QMutexLocker locker(&m_Mutex);
+
+  for (int i = 0; i < nCount && m_Idle.size() < MaxIdle; i++) {
+    Entry entry;
+    entry.sFilepath = sFilepath;
+    entry.modified = modified;
+    entry.nNumOfFields = nNumOfFields;
+    entry.nHeightTowerWin = nHeightTowerWin;
+    entry.pRunner = createRunner(nNumOfFields, nHeightTowerWin);
+    QMetaObject::invokeMethod(entry.pRunner, "load", Qt::QueuedConnection,
+                              Q_ARG(QString, sFilepath), Q_ARG(quint8, 0),
+                              Q_ARG(quint64, 0));
+    m_Idle.append(entry);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+ScriptRunner *ScriptPool::createRunner(const quint8 nNumOfFields,
+                                       const quint8 nHeightTowerWin) {
+  ScriptRunner *pRunner(new ScriptRunner(nNumOfFields, nHeightTowerWin));
+  QThread *pThread(new QThread());
+  pRunner->moveToThread(pThread);
+  QObject::connect(pThread, SIGNAL(finished()), pRunner, SLOT(deleteLater()));
+  // The thread object is deleted by the main thread, see destroyRunner();
+  // the creating thread may be a tournament worker without event loop
+  pThread->moveToThread(QCoreApplication::instance()->thread());
+  pThread->start();
+  return pRunner;
+}
+
+// Doesn't wait for the thread: the script is stopped, but before Qt 5.14
+// a loop without any call of the cpu object can't be interrupted (see
+// ScriptRunner::createEngine()). Such a thread is left running instead of
+// being terminated, which could corrupt the whole process.
+void ScriptPool::destroyRunner(ScriptRunner *pRunner) {
+  QThread *pThread(pRunner->thread());
+  pRunner->stop();
+  QObject::connect(pThread, SIGNAL(finished()), pThread, SLOT(deleteLater()));
+  pThread->quit();
+}
@@ -0,0 +1,86 @@
+/**
+ * \file scriptpool.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition of the CPU script engine pool.
+ */
+
+#ifndef SCRIPTPOOL_H_
+#define SCRIPTPOOL_H_
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+class ScriptRunner;
+
+/**
+ * \class ScriptPool
+ * \brief Idle script runners (JS engine + thread) of finished games.
+ *
+ * Runners are keyed by script path, file modification time and board
+ * size, so a new game gets an engine which has evaluated the script
+ * already. The pool is shared by all threads and deleted together with
+ * the application object.
+ */
+class ScriptPool {
+  public:
+    enum { MaxIdle = 32 };
+
+    static ScriptPool *instance();
+    ScriptRunner *acquire(const QString &sFilepath, const quint8 nNumOfFields,
+                          const quint8 nHeightTowerWin);
+    void release(ScriptRunner *pRunner, const bool bReusable);
+    void warmUp(const QString &sFilepath, const quint8 nNumOfFields,
+                const quint8 nHeightTowerWin, const int nCount);
+
+  private:
+    /**
+     * \struct Entry
+     * \brief Idle runner and the script it has loaded.
+     */
+    struct Entry {
+      QString sFilepath;
+      QDateTime modified;
+      quint8 nNumOfFields;
+      quint8 nHeightTowerWin;
+      ScriptRunner *pRunner;
+    };
+
+    ScriptPool();
+    ~ScriptPool();
+    Q_DISABLE_COPY(ScriptPool)
+
+    static void deleteInstance();
+    static ScriptRunner *createRunner(const quint8 nNumOfFields,
+                                      const quint8 nHeightTowerWin);
+    static void destroyRunner(ScriptRunner *pRunner);
+
+    static ScriptPool *m_pInstance;
+    static QMutex m_InstanceMutex;
+    QMutex m_Mutex;
+    QList<Entry> m_Idle;
+    QHash<ScriptRunner *, Entry> m_InUse;
+};
+
+#endif  // SCRIPTPOOL_H_
@@ -0,0 +1,932 @@
+/**
+ * \file scriptrunner.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Interface to CPU script JS engine, running in the thread of OpponentJS.
+ */
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaMethod>
+#include <QMutexLocker>
+#include <QQmlEngine>
+
+#include "./scriptrunner.h"
+
+#ifdef HAVE_QML_PRIVATE
+#include <private/qv4engine_p.h>
+#include <private/qv4mm_p.h>
+#endif
+
+ScriptRunner::ScriptRunner(const quint8 nNumOfFields,
+                           const quint8 nHeightTowerWin)
+  : QObject(0),
+    m_nID(0),
+    m_nNumOfFields(nNumOfFields),
+    m_nHeightTowerWin(nHeightTowerWin),
+    m_jsEngine(NULL),
+    m_bLoaded(false),
+    m_nMemoryLimitMB(0),
+    m_bCollectGarbage(false),
+    m_nHeap(-1),
+    m_nHeapCheckCalls(0),
+    m_nTargetMs(-1),
+    m_nNextHandle(1),
+    m_Interrupted(0),
+    m_Stopped(0) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// A runner from the ScriptPool has loaded the script already and is only
+// reset for the new game
+void ScriptRunner::load(const QString &sFilepath, const quint8 nID,
+                        const quint64 nSeed) {
+  if (!this->startCall()) {
+    emit loaded(false);
+    return;
+  }
+  m_nID = nID;
+  m_Random.seed(nSeed);
+  this->takeStats();  // Timing of the former game was not collected
+  bool bOk(false);
+  if (m_bLoaded && sFilepath == m_sFilepath) {
+    bOk = this->resetScript();
+  }
+  if (!bOk) {
+    this->createEngine();
+    bOk = this->loadAndEvalCpuScript(sFilepath);
+  }
+  this->checkHeap();
+  if (bOk && 0 != m_nMemoryLimitMB &&
+      m_nHeap > static_cast<qint64>(m_nMemoryLimitMB) * 1024 * 1024) {
+    qCritical() << "CPU" << m_nID << "script exceeded memory limit of"
+                << m_nMemoryLimitMB << "MB while loading";
+    bOk = false;
+  }
+  m_bLoaded = bOk;
+  emit loaded(bOk);
+}
+
+// ---------------------------------------------------------------------------
+
+// The engine has to be created in the thread running the script
+void ScriptRunner::createEngine() {
+  QJSEngine *pEngine(new QJSEngine(this));
+  QJSEngine *pOldEngine(m_jsEngine);
+  {
+    QMutexLocker locker(&m_EngineMutex);
+    m_jsEngine = pEngine;
+  }
+  if (NULL != pOldEngine) {
+    m_obj = QJSValue();
+    m_onSetStone = QJSValue();
+    m_onMove = QJSValue();
+    m_jsBoard = QJSValue();
+    m_jsTowers.clear();
+    m_jsColumns.clear();
+    m_freeze = QJSValue();
+    delete pOldEngine;
+  }
+
+  // Runner is deleted by its thread / the ScriptPool, not by the JS engine
+  QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+  m_obj = m_jsEngine->globalObject();
+  QJSValue cpu(m_jsEngine->newQObject(this));
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+  cpu = this->interruptibleCpu(cpu);
+#endif
+  m_obj.setProperty("cpu", cpu);
+  // Math.random() of old scripts uses the seeded generator as well
+  m_jsEngine->evaluate("Math.random = function() { return cpu.random(); };");
+  this->createBoard();
+}
+
+// ---------------------------------------------------------------------------
+
+// Without QJSEngine::setInterrupted() (Qt < 5.14) the script sees a
+// wrapper of the "cpu" object instead, whose functions throw after
+// interrupt(). Math.random() uses cpu.random() as well, so only a loop
+// without any call of them can't be stopped.
+QJSValue ScriptRunner::interruptibleCpu(const QJSValue &cpu) {
+  QStringList sListNames;
+  const QMetaObject *pMeta(this->metaObject());
+  for (int i = pMeta->methodOffset(); i < pMeta->methodCount(); i++) {
+    const QMetaMethod method(pMeta->method(i));
+    if (QMetaMethod::Slot == method.methodType() &&
+        QMetaMethod::Public == method.access()) {
+      sListNames << QString::fromLatin1(method.name());
+    }
+  }
+  sListNames.removeDuplicates();  // Overloads for default arguments
+
+  QJSValue wrap(m_jsEngine->evaluate(
+                  "(function(cpu, names) {"
+                  "  var wrapper = {};"
+                  "  names.forEach(function(name) {"
+                  "    wrapper[name] = function() {"
+                  "      if (cpu.interrupted()) {"
+                  "        throw new Error('Interrupted');"
+                  "      }"
+                  "      return cpu[name].apply(cpu, arguments);"
+                  "    };"
+                  "  });"
+                  "  return wrapper;"
+                  "})"));
+  return wrap.call(QJSValueList() << cpu
+                   << m_jsEngine->toScriptValue(sListNames));
+}
+
+// ---------------------------------------------------------------------------
+
+// Called by the watchdog of OpponentJS from its own thread
+void ScriptRunner::interrupt() {
+  m_Interrupted.store(1);
+  QMutexLocker locker(&m_EngineMutex);
+  if (NULL != m_jsEngine) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    m_jsEngine->setInterrupted(true);
+#endif
+  }
+}
+
+// Called by the ScriptPool from another thread before the runner is
+// dropped: the running and all further calls of the script end
+void ScriptRunner::stop() {
+  m_Stopped.store(1);
+  this->interrupt();
+}
+
+// Clears the interruption of a previous call; false after stop()
+bool ScriptRunner::startCall() {
+  m_sMemoryError.clear();
+  m_nHeapCheckCalls = 0;
+  m_Interrupted.store(0);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+  if (NULL != m_jsEngine) {
+    m_jsEngine->setInterrupted(false);
+  }
+#endif
+  return 0 == m_Stopped.load();
+}
+
+// Scripts can end long loops by themselves, before being interrupted
+bool ScriptRunner::interrupted() const {
+  return 0 != m_Interrupted.load();
+}
+
+// Only called while the runner is idle (before loading the script)
+void ScriptRunner::setMemoryLimit(const quint32 nLimitMB,
+                                  const bool bCollectGarbage) {
+  m_nMemoryLimitMB = nLimitMB;
+  m_bCollectGarbage = bCollectGarbage;
+}
+
+// The heap can only be measured with the private QtQml headers, see
+// stackandconquer.pro
+bool ScriptRunner::canMeasureHeap() {
+#ifdef HAVE_QML_PRIVATE
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Bytes allocated by the JS heap; needs the private Qt headers, otherwise
+// -1 (unknown) and the memory limit is not checked
+qint64 ScriptRunner::heapUsage() const {
+#ifdef HAVE_QML_PRIVATE
+  const QV4::MemoryManager *pMM(m_jsEngine->handle()->memoryManager);
+  return static_cast<qint64>(pMM->getUsedMem() + pMM->getLargeItemsMem());
+#else
+  return -1;
+#endif
+}
+
+// During a move the heap is checked by the helper calls and Math.random()
+// (every HeapCheckCalls); it can only be measured in the thread of the
+// script. Garbage doesn't count, it is collected before the script is
+// interrupted.
+void ScriptRunner::checkHeapLimit() {
+  if (0 == m_nMemoryLimitMB || ++m_nHeapCheckCalls < HeapCheckCalls ||
+      !m_sMemoryError.isEmpty()) {
+    return;
+  }
+  m_nHeapCheckCalls = 0;
+  const qint64 nLimit(static_cast<qint64>(m_nMemoryLimitMB) * 1024 * 1024);
+  qint64 nHeap(this->heapUsage());
+  if (nHeap <= nLimit) {  // Or unknown (-1)
+    return;
+  }
+  m_jsEngine->collectGarbage();
+  nHeap = this->heapUsage();
+  if (nHeap > nLimit) {
+    m_sMemoryError = this->memoryLimitError(nHeap);
+    this->interrupt();
+  }
+}
+
+QString ScriptRunner::memoryLimitError(const qint64 nHeap) const {
+  return QString("Memory limit of %1 MB exceeded (%2 MB)")
+      .arg(m_nMemoryLimitMB).arg(nHeap / (1024 * 1024));
+}
+
+// Runs after a move has been sent, i.e. outside of the time of the move
+void ScriptRunner::checkHeap() {
+  if (NULL == m_jsEngine) {
+    return;
+  }
+  if (m_bCollectGarbage) {
+    m_jsEngine->collectGarbage();
+  }
+  m_nHeap = this->heapUsage();
+  if (m_nHeap >= 0) {
+    qDebug() << "CPU" << m_nID << "script heap:" << m_nHeap / 1024 << "KB";
+    QMutexLocker locker(&m_StatsMutex);
+    m_Stats.addHeap(m_nHeap);
+  }
+}
+
+// Returns the statistics since the last call; thread safe
+ScriptStats ScriptRunner::takeStats() {
+  QMutexLocker locker(&m_StatsMutex);
+  const ScriptStats stats(m_Stats);
+  m_Stats = ScriptStats();
+  return stats;
+}
+
+void ScriptRunner::addTiming(const ScriptStats::Stage stage,
+                             const qint64 nNsecs) {
+  QMutexLocker locker(&m_StatsMutex);
+  m_Stats.add(stage, nNsecs);
+}
+
+void ScriptRunner::countHelper() {
+  {
+    QMutexLocker locker(&m_StatsMutex);
+    m_Stats.countHelper();
+  }
+  this->checkHeapLimit();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool ScriptRunner::loadAndEvalCpuScript(const QString &sFilepath) {
+  QFile f(sFilepath);
+  if (!f.open(QFile::ReadOnly)) {
+    qWarning() << "Couldn't open JS file:" << sFilepath;
+    return false;
+  }
+  m_sSource = QString::fromUtf8(f.readAll());
+  m_sFilepath = sFilepath;
+  f.close();
+  qDebug() << "CPU" << m_nID << "script:" << sFilepath;
+  return this->evalCpuScript();
+}
+
+// ---------------------------------------------------------------------------
+
+bool ScriptRunner::evalCpuScript() {
+  m_obj.setProperty("nID", m_nID);
+  m_obj.setProperty("nNumOfFields", m_nNumOfFields);
+  m_obj.setProperty("nHeightTowerWin", m_nHeightTowerWin);
+
+  QJSValue result(m_jsEngine->evaluate(m_sSource, m_sFilepath));
+  if (result.isError()) {
+    qCritical() << "Error in CPU" << m_nID << "script at line" <<
+                   result.property("lineNumber").toInt() <<
+                   "\n" << result.toString();
+    return false;
+  }
+
+  // Check if makeMove() is available for calling the script
+  if (!m_obj.hasProperty("makeMove") ||
+      !m_obj.property("makeMove").isCallable()) {
+    qCritical() << "Error in CPU" << m_nID << "script - function makeMove() " <<
+                   "not found or not callable!";
+    return false;
+  }
+
+  // Incremental updates, only used if the script implements them
+  m_onSetStone = m_obj.property("onSetStone");
+  m_onMove = m_obj.property("onMove");
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+// Scripts can implement resetGame() to clear their state for a new game,
+// otherwise the script is evaluated again in the warm engine
+bool ScriptRunner::resetScript() {
+  m_Positions.clear();
+  m_nNextHandle = 1;
+
+  QJSValue reset(m_obj.property("resetGame"));
+  if (!reset.isCallable()) {
+    return this->evalCpuScript();
+  }
+
+  m_obj.setProperty("nID", m_nID);
+  QJSValue result(reset.call());
+  if (result.isError()) {
+    qCritical() << "CPU" << m_nID << "- Error calling \"resetGame\":" <<
+                   result.toString();
+    return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ScriptRunner::makeMove(const GameState &state, const quint32 nMoveNo,
+                            const int nTargetMs) {
+  if (!this->startCall()) {
+    return;
+  }
+  m_MoveTimer.start();
+  m_nTargetMs = nTargetMs;
+  // Heap was measured after the previous move
+  if (0 != m_nMemoryLimitMB &&
+      m_nHeap > static_cast<qint64>(m_nMemoryLimitMB) * 1024 * 1024) {
+    const QString sError(this->memoryLimitError(m_nHeap));
+    qCritical() << "CPU" << m_nID << sError;
+    emit scriptError(sError, nMoveNo);
+    return;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  const quint8 nPossibleMove(state.findPossibleMoves(m_nID));
+  this->updateBoard(state);
+  m_State = state;
+  m_Positions.clear();
+  qint64 nLap(timer.nsecsElapsed());
+  this->addTiming(ScriptStats::Board, nLap);
+
+  QJSValue result = m_obj.property("makeMove")
+                    .call(QJSValueList() << nPossibleMove);
+  this->addTiming(ScriptStats::Script, timer.nsecsElapsed() - nLap);
+  nLap = timer.nsecsElapsed();
+  if (!m_sMemoryError.isEmpty()) {  // Also if the script caught it
+    qCritical() << "CPU" << m_nID << m_sMemoryError;
+    emit scriptError(m_sMemoryError, nMoveNo);
+    return;
+  }
+  if (result.isError()) {
+    qCritical() << "CPU" << m_nID <<
+                   "- Error calling \"makeMove\" function at line:" <<
+                   result.property("lineNumber").toInt() <<
+                   "\n" << result.toString();
+    emit scriptError("Exception in makeMove(): " + result.toString(),
+                     nMoveNo);
+    return;
+  }
+
+  QString sError;
+  const Move move(this->moveFromJS(result, &sError));
+  if (!move.isValid()) {
+    qCritical() << "CPU" << m_nID << "script invalid return from makeMove():" <<
+                   result.toString() << "-" << sError;
+    emit scriptError(sError, nMoveNo);
+    return;
+  }
+
+  const GameState::MoveResult moveResult(state.checkMove(move));
+  this->addTiming(ScriptStats::Return, timer.nsecsElapsed() - nLap);
+  if (GameState::MoveOk != moveResult) {
+    sError = "Invalid move " + state.moveToString(move) + " (" +
+             GameState::resultToString(moveResult) + ")";
+    qCritical() << "CPU" << m_nID << sError;
+    emit scriptError(sError, nMoveNo);
+    return;
+  }
+
+  emit madeMove(move, nMoveNo);
+  this->checkHeap();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// onSetStone([x, y], nPlayer) / onMove([x, y], [x, y], nStones, nPlayer)
+// are called for the moves of both players (incl. the own ones). A tower
+// reaching nHeightTowerWin is conquered and removed by the move.
+void ScriptRunner::moveApplied(const Move &move, const quint8 nPlayer) {
+  if (0 != m_Stopped.load()) {
+    return;
+  }
+  QElapsedTimer timer;
+  timer.start();
+  QJSValue result;
+  if (move.isSetStone()) {
+    if (!m_onSetStone.isCallable()) {
+      return;
+    }
+    result = m_onSetStone.call(QJSValueList() << this->fieldToJS(move.nTo)
+                               << nPlayer);
+  } else {
+    if (!m_onMove.isCallable()) {
+      return;
+    }
+    result = m_onMove.call(QJSValueList() << this->fieldToJS(move.nFrom)
+                           << this->fieldToJS(move.nTo) << move.nStones
+                           << nPlayer);
+  }
+  this->addTiming(ScriptStats::Callback, timer.nsecsElapsed());
+
+  if (result.isError()) {
+    qCritical() << "CPU" << m_nID <<
+                   "- Error calling move callback at line:" <<
+                   result.property("lineNumber").toInt() <<
+                   "\n" << result.toString();
+    emit scriptError(m_sMemoryError.isEmpty()
+                     ? "Exception in move callback: " + result.toString()
+                     : m_sMemoryError, 0);
+  }
+}
+
+QJSValue ScriptRunner::fieldToJS(const qint8 nIndex) const {
+  QJSValue field(m_jsEngine->newArray(2));
+  field.setProperty(0, nIndex % m_nNumOfFields);
+  field.setProperty(1, nIndex / m_nNumOfFields);
+  return field;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Global "board" (board[x][y] = stones from bottom to top) is created once.
+// Towers and columns are frozen, so a script can't corrupt the board of
+// later moves; a changed tower (and its column) is replaced by a new array.
+// Old scripts can still read the board as JSON string "jsboard", which is
+// only built, if it is accessed.
+void ScriptRunner::createBoard() {
+  m_freeze = m_jsEngine->evaluate("Object.freeze");
+  m_jsBoard = m_jsEngine->newArray(m_nNumOfFields);
+  const int nFields(m_nNumOfFields * m_nNumOfFields);
+  for (int nIndex = 0; nIndex < nFields; nIndex++) {
+    // Same field order as GameState (index = y * size + x)
+    m_jsTowers << m_freeze.call(QJSValueList() << m_jsEngine->newArray(0));
+  }
+  for (int x = 0; x < m_nNumOfFields; x++) {
+    m_jsColumns << this->columnToJS(x);
+    m_jsBoard.setProperty(x, m_jsColumns.last());
+  }
+  m_nHeights.fill(0, nFields);
+  m_nColors.fill(0, nFields);
+  m_obj.setProperty("board", m_jsBoard);
+
+  QJSValue defineJsBoard(m_jsEngine->evaluate(
+                           "(function(global, board) {"
+                           "  Object.defineProperty(global, 'jsboard', {"
+                           "    get: function() { return JSON.stringify(board); }"
+                           "  });"
+                           "})"));
+  defineJsBoard.call(QJSValueList() << m_obj << m_jsBoard);
+}
+
+// Frozen array of the towers board[x][0..n-1]
+QJSValue ScriptRunner::columnToJS(const int nX) {
+  QJSValue column(m_jsEngine->newArray(m_nNumOfFields));
+  for (int y = 0; y < m_nNumOfFields; y++) {
+    column.setProperty(y, m_jsTowers[y * m_nNumOfFields + nX]);
+  }
+  return m_freeze.call(QJSValueList() << column);
+}
+
+// ---------------------------------------------------------------------------
+
+void ScriptRunner::updateBoard(const GameState &state) {
+  // Scripts may have assigned an own (parsed) board to the global name or
+  // replaced columns of the board array, which itself is not frozen (the
+  // "jsboard" getter refers to it)
+  m_obj.setProperty("board", m_jsBoard);
+  const Position &pos(state.getPosition());
+  for (int x = 0; x < m_nNumOfFields; x++) {
+    bool bChanged(false);
+    for (int y = 0; y < m_nNumOfFields; y++) {
+      const int nIndex(y * m_nNumOfFields + x);
+      const quint8 nHeight(pos.height(nIndex));
+      const quint8 nColors(pos.colors(nIndex));
+      if (nHeight == m_nHeights[nIndex] && nColors == m_nColors[nIndex]) {
+        continue;
+      }
+
+      QJSValue tower(m_jsEngine->newArray(nHeight));
+      for (quint8 i = 0; i < nHeight; i++) {
+        tower.setProperty(i, static_cast<int>(pos.stone(nIndex, i)));
+      }
+      m_jsTowers[nIndex] = m_freeze.call(QJSValueList() << tower);
+      m_nHeights[nIndex] = nHeight;
+      m_nColors[nIndex] = nColors;
+      bChanged = true;
+    }
+    if (bChanged) {
+      m_jsColumns[x] = this->columnToJS(x);
+    }
+    m_jsBoard.setProperty(x, m_jsColumns[x]);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Handle 0 is the position of the current makeMove() call. Positions are
+// released automatically before the next call of makeMove().
+int ScriptRunner::newPosition(const int nSource) {
+  this->countHelper();
+  if (m_Positions.size() >= MaxPositions) {
+    qWarning() << "CPU" << m_nID << "- too many positions, limit:"
+               << MaxPositions;
+    return -1;
+  }
+
+  ScriptPosition pos;
+  if (0 == nSource) {
+    pos.state = m_State;
+  } else {
+    const ScriptPosition *pSource(this->scriptPosition(nSource));
+    if (NULL == pSource) {
+      return -1;
+    }
+    pos.state = pSource->state;
+  }
+  m_Positions.insert(m_nNextHandle, pos);
+  return m_nNextHandle++;
+}
+
+void ScriptRunner::freePosition(const int nHandle) {
+  this->countHelper();
+  m_Positions.remove(nHandle);
+}
+
+// Moves in the format accepted as return value of makeMove()
+QJSValue ScriptRunner::legalMoves(const int nHandle) {
+  this->countHelper();
+  QVector<Move> moves;
+  if (0 == nHandle) {
+    m_State.generateMoves(&moves);
+  } else {
+    const ScriptPosition *pPos(this->scriptPosition(nHandle));
+    if (NULL == pPos) {
+      return QJSValue();
+    }
+    pPos->state.generateMoves(&moves);
+  }
+  return this->movesToJS(moves);
+}
+
+// Moves with which nPlayer would conquer a tower, if it was his turn
+QJSValue ScriptRunner::winningMoves(const int nHandle, const int nPlayer) {
+  this->countHelper();
+  if (nPlayer < 1 || nPlayer > 2) {
+    return QJSValue();
+  }
+  GameState state(m_State);
+  if (0 != nHandle) {
+    const ScriptPosition *pPos(this->scriptPosition(nHandle));
+    if (NULL == pPos) {
+      return QJSValue();
+    }
+    state = pPos->state;
+  }
+  state.setCurrentPlayer(nPlayer);
+
+  QVector<Move> moves;
+  QVector<Move> winning;
+  GameState::Undo undo;
+  const quint8 nWon(state.getWonTowers(nPlayer));
+  state.generateMoves(&moves);
+  foreach (const Move &move, moves) {
+    if (move.isSetStone() ||
+        state.getHeight(move.nTo) + move.nStones <
+        state.getMaxTowerHeight()) {
+      continue;
+    }
+    state.applyMove(move, &undo);
+    if (state.getWonTowers(nPlayer) > nWon) {
+      winning.append(move);
+    }
+    state.undoMove(move, undo);
+  }
+  return this->movesToJS(winning);
+}
+
+// All child positions in one call, packed into flat arrays (field index
+// = y * nNumOfFields + x, child i at i * nNumOfFields^2):
+// {count, moves, heights, owners (top stone), won1, won2, winner}.
+// scoreFn(result) is called once and returns an array with a score per
+// child, result.scores and result.best (index of highest score) are added.
+QJSValue ScriptRunner::children(const int nHandle, const QJSValue &scoreFn) {
+  this->countHelper();
+  GameState state(m_State);
+  if (0 != nHandle) {
+    const ScriptPosition *pPos(this->scriptPosition(nHandle));
+    if (NULL == pPos) {
+      return QJSValue();
+    }
+    state = pPos->state;
+  }
+
+  QVector<Move> moves;
+  state.generateMoves(&moves);
+  const int nCount(moves.size());
+  const int nFields(m_nNumOfFields * m_nNumOfFields);
+  QJSValue heights(m_jsEngine->newArray(nCount * nFields));
+  QJSValue owners(m_jsEngine->newArray(nCount * nFields));
+  QJSValue won1(m_jsEngine->newArray(nCount));
+  QJSValue won2(m_jsEngine->newArray(nCount));
+  QJSValue winner(m_jsEngine->newArray(nCount));
+  GameState::Undo undo;
+  for (int i = 0; i < nCount; i++) {
+    state.applyMove(moves[i], &undo);
+    const quint32 nOffset(i * nFields);
+    for (int nIndex = 0; nIndex < nFields; nIndex++) {
+      heights.setProperty(nOffset + nIndex, state.getHeight(nIndex));
+      owners.setProperty(nOffset + nIndex, state.getTopStone(nIndex));
+    }
+    won1.setProperty(i, state.getWonTowers(1));
+    won2.setProperty(i, state.getWonTowers(2));
+    winner.setProperty(i, state.getWinner());
+    state.undoMove(moves[i], undo);
+  }
+
+  QJSValue result(m_jsEngine->newObject());
+  result.setProperty("count", nCount);
+  result.setProperty("moves", this->movesToJS(moves));
+  result.setProperty("heights", heights);
+  result.setProperty("owners", owners);
+  result.setProperty("won1", won1);
+  result.setProperty("won2", won2);
+  result.setProperty("winner", winner);
+  if (scoreFn.isCallable() && !this->scoreChildren(&result, scoreFn, nCount)) {
+    return QJSValue();
+  }
+  return result;
+}
+
+bool ScriptRunner::scoreChildren(QJSValue *pResult, const QJSValue &scoreFn,
+                                 const int nCount) {
+  QJSValue scores(QJSValue(scoreFn).call(QJSValueList() << *pResult));
+  if (scores.isError() || !scores.isArray() ||
+      scores.property("length").toInt() != nCount) {
+    qWarning() << "CPU" << m_nID << "- children(): scoring function has to"
+               << "return an array with" << nCount << "numbers -"
+               << scores.toString();
+    return false;
+  }
+
+  int nBest(-1);
+  double dBest(0);
+  for (int i = 0; i < nCount; i++) {
+    const double dScore(scores.property(i).toNumber());
+    if (-1 == nBest || dScore > dBest) {
+      nBest = i;
+      dBest = dScore;
+    }
+  }
+  pResult->setProperty("scores", scores);
+  pResult->setProperty("best", nBest);
+  return true;
+}
+
+bool ScriptRunner::apply(const int nHandle, const QJSValue &move) {
+  this->countHelper();
+  ScriptPosition *pPos(this->scriptPosition(nHandle));
+  if (NULL == pPos) {
+    return false;
+  }
+  QString sError;
+  const Move m(this->moveFromJS(move, &sError));
+  if (!m.isValid() || GameState::MoveOk != pPos->state.checkMove(m)) {
+    return false;
+  }
+  pPos->undos.append(GameState::Undo());
+  pPos->moves.append(m);
+  pPos->state.applyMove(m, &pPos->undos.last());
+  return true;
+}
+
+bool ScriptRunner::undo(const int nHandle) {
+  this->countHelper();
+  ScriptPosition *pPos(this->scriptPosition(nHandle));
+  if (NULL == pPos || pPos->undos.isEmpty()) {
+    return false;
+  }
+  pPos->state.undoMove(pPos->moves.takeLast(), pPos->undos.takeLast());
+  return true;
+}
+
+int ScriptRunner::currentPlayer(const int nHandle) {
+  this->countHelper();
+  if (0 == nHandle) {
+    return m_State.getCurrentPlayer();
+  }
+  const ScriptPosition *pPos(this->scriptPosition(nHandle));
+  return NULL == pPos ? 0 : pPos->state.getCurrentPlayer();
+}
+
+ScriptRunner::ScriptPosition *ScriptRunner::scriptPosition(
+    const int nHandle) {
+  QHash<int, ScriptPosition>::iterator it(m_Positions.find(nHandle));
+  if (m_Positions.end() == it) {
+    qWarning() << "CPU" << m_nID << "- invalid position handle:" << nHandle;
+    return NULL;
+  }
+  return &it.value();
+}
+
+QJSValue ScriptRunner::movesToJS(const QVector<Move> &moves) const {
+  QJSValue list(m_jsEngine->newArray(moves.size()));
+  for (int i = 0; i < moves.size(); i++) {
+    list.setProperty(i, this->moveToJS(moves[i]));
+  }
+  return list;
+}
+
+// [[x, y]] = set stone, [[x, y], [x, y], nStones] = move tower
+QJSValue ScriptRunner::moveToJS(const Move &move) const {
+  QJSValue value(m_jsEngine->newArray(move.isSetStone() ? 1 : 3));
+  if (move.isSetStone()) {
+    value.setProperty(0, this->fieldToJS(move.nTo));
+  } else {
+    value.setProperty(0, this->fieldToJS(move.nFrom));
+    value.setProperty(1, this->fieldToJS(move.nTo));
+    value.setProperty(2, move.nStones);
+  }
+  return value;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Accepted return values of makeMove():
+//   [x, y] / [[x, y]]                 set stone
+//   [[x, y], [x, y], nStones]         move nStones from first to second field
+//   {to: [x, y]}                      set stone
+//   {from: [x, y], to: [x, y], stones: nStones}
+//   "x,y" / "x,y|x,y|nStones"         old string protocol
+Move ScriptRunner::moveFromJS(const QJSValue &value, QString *pError) const {
+  qint8 nFrom(-1);
+  qint8 nTo(-1);
+  int nStones(1);
+
+  if (value.isString()) {
+    const QStringList sListRet(value.toString().split("|"));
+    if ((1 != sListRet.size() && 3 != sListRet.size()) ||
+        !this->fieldFromString(sListRet[0], &nTo)) {
+      *pError = "Invalid move string";
+      return Move();
+    }
+    if (3 == sListRet.size()) {
+      bool bOk(false);
+      nFrom = nTo;
+      nStones = sListRet[2].trimmed().toInt(&bOk, 10);
+      if (!bOk || !this->fieldFromString(sListRet[1], &nTo)) {
+        *pError = "Invalid move string";
+        return Move();
+      }
+    }
+  } else if (value.isArray()) {
+    const int nLength(value.property("length").toInt());
+    if (2 == nLength && value.property(0).isNumber()) {
+      if (!this->fieldFromJS(value, &nTo)) {
+        *pError = "Field out of board";
+        return Move();
+      }
+    } else if (1 == nLength) {
+      if (!this->fieldFromJS(value.property(0), &nTo)) {
+        *pError = "Field out of board";
+        return Move();
+      }
+    } else if (3 == nLength) {
+      if (!this->fieldFromJS(value.property(0), &nFrom) ||
+          !this->fieldFromJS(value.property(1), &nTo)) {
+        *pError = "Field out of board";
+        return Move();
+      }
+      if (!this->integerFromJS(value.property(2), &nStones)) {
+        *pError = "Number of stones is not an integer";
+        return Move();
+      }
+    } else {
+      *pError = "Invalid move array";
+      return Move();
+    }
+  } else if (value.isObject() && value.hasProperty("to")) {
+    if (!this->fieldFromJS(value.property("to"), &nTo)) {
+      *pError = "Field out of board";
+      return Move();
+    }
+    if (value.hasProperty("from")) {
+      if (!this->fieldFromJS(value.property("from"), &nFrom)) {
+        *pError = "Field out of board";
+        return Move();
+      }
+      if (!this->integerFromJS(value.property("stones"), &nStones)) {
+        *pError = "Number of stones is not an integer";
+        return Move();
+      }
+    }
+  } else {
+    *pError = "makeMove() did not return a move";
+    return Move();
+  }
+
+  if (nStones <= 0 || nStones >= m_nHeightTowerWin) {
+    *pError = "Invalid number of stones to move";
+    return Move();
+  }
+  return Move(nFrom, nTo, static_cast<quint8>(nStones));
+}
+
+bool ScriptRunner::fieldFromJS(const QJSValue &value, qint8 *pIndex) const {
+  int nX(-1);
+  int nY(-1);
+  return value.isArray() && 2 == value.property("length").toInt() &&
+      this->integerFromJS(value.property(0), &nX) &&
+      this->integerFromJS(value.property(1), &nY) &&
+      this->fieldIndex(nX, nY, pIndex);
+}
+
+bool ScriptRunner::fieldFromString(const QString &sField, qint8 *pIndex) const {
+  const QStringList sListPoint(sField.split(","));
+  bool bOk1(false);
+  bool bOk2(false);
+  if (2 != sListPoint.size()) {
+    return false;
+  }
+  const int nX(sListPoint[0].trimmed().toInt(&bOk1, 10));
+  const int nY(sListPoint[1].trimmed().toInt(&bOk2, 10));
+  return bOk1 && bOk2 && this->fieldIndex(nX, nY, pIndex);
+}
+
+bool ScriptRunner::integerFromJS(const QJSValue &value, int *pInt) const {
+  if (!value.isNumber()) {
+    return false;
+  }
+  const double dValue(value.toNumber());
+  if (dValue < -128 || dValue > 127 || static_cast<int>(dValue) != dValue) {
+    return false;
+  }
+  *pInt = static_cast<int>(dValue);
+  return true;
+}
+
+bool ScriptRunner::fieldIndex(const int nX, const int nY, qint8 *pIndex) const {
+  if (nX < 0 || nY < 0 || nX >= m_nNumOfFields || nY >= m_nNumOfFields) {
+    return false;
+  }
+  *pIndex = static_cast<qint8>(nY * m_nNumOfFields + nX);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ScriptRunner::log(const QString &sMsg) {
+  {
+    QMutexLocker locker(&m_StatsMutex);
+    m_Stats.countLog();
+  }
+  qDebug() << sMsg;
+}
+
+// Reproducible with the same game seed (command line option --seed)
+double ScriptRunner::random() {
+  this->checkHeapLimit();
+  return m_Random.real();
+}
+
+// Milliseconds, which the current move should take at most, -1 = no limit
+// besides the time limit of the script
+int ScriptRunner::timeLeft() const {
+  if (m_nTargetMs < 0) {
+    return -1;
+  }
+  return static_cast<int>(qMax(Q_INT64_C(0),
+                               m_nTargetMs - m_MoveTimer.elapsed()));
+}
@@ -0,0 +1,162 @@
+/**
+ * \file scriptrunner.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition of the CPU script runner.
+ */
+
+#ifndef SCRIPTRUNNER_H_
+#define SCRIPTRUNNER_H_
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJSEngine>
+#include <QMutex>
+#include <QVector>
+
+#include "./gamestate.h"
+#include "./random.h"
+#include "./scriptstats.h"
+
+/**
+ * \class ScriptRunner
+ * \brief JS engine of one CPU script, lives in an own worker thread and
+ *        is kept by the ScriptPool between games. It is also the "cpu"
+ *        object seen by the script.
+ */
+class ScriptRunner : public QObject {
+  Q_OBJECT
+
+  public:
+    enum { MaxPositions = 1000, HeapCheckCalls = 64 };
+
+    ScriptRunner(const quint8 nNumOfFields, const quint8 nHeightTowerWin);
+    void interrupt();
+    void stop();
+    void setMemoryLimit(const quint32 nLimitMB, const bool bCollectGarbage);
+    static bool canMeasureHeap();
+    ScriptStats takeStats();
+
+  public slots:
+    void log(const QString &sMsg);
+    double random();
+    int timeLeft() const;
+    bool interrupted() const;
+
+    // Native helpers for the scripts, see DummyCPU.js
+    int newPosition(const int nSource = 0);
+    void freePosition(const int nHandle);
+    QJSValue legalMoves(const int nHandle);
+    QJSValue winningMoves(const int nHandle, const int nPlayer);
+    QJSValue children(const int nHandle,
+                      const QJSValue &scoreFn = QJSValue());
+    bool apply(const int nHandle, const QJSValue &move);
+    bool undo(const int nHandle);
+    int currentPlayer(const int nHandle);
+
+  signals:
+    void loaded(bool bOk);
+    void madeMove(const Move &move, const quint32 nMoveNo);
+    void scriptError(const QString &sError, const quint32 nMoveNo);
+
+  private slots:
+    // Private, so they are not visible for the script
+    void load(const QString &sFilepath, const quint8 nID,
+              const quint64 nSeed);
+    void makeMove(const GameState &state, const quint32 nMoveNo,
+                  const int nTargetMs);
+    void moveApplied(const Move &move, const quint8 nPlayer);
+
+  private:
+    /**
+     * \struct ScriptPosition
+     * \brief Position owned by the script, valid during one makeMove() call.
+     */
+    struct ScriptPosition {
+      GameState state;
+      QVector<Move> moves;  // Applied moves, for undo()
+      QVector<GameState::Undo> undos;
+    };
+
+    void addTiming(const ScriptStats::Stage stage, const qint64 nNsecs);
+    void countHelper();
+    QJSValue interruptibleCpu(const QJSValue &cpu);
+    bool startCall();
+    qint64 heapUsage() const;
+    void checkHeap();
+    void checkHeapLimit();
+    QString memoryLimitError(const qint64 nHeap) const;
+    void createEngine();
+    bool loadAndEvalCpuScript(const QString &sFilepath);
+    bool evalCpuScript();
+    bool resetScript();
+    ScriptPosition *scriptPosition(const int nHandle);
+    bool scoreChildren(QJSValue *pResult, const QJSValue &scoreFn,
+                       const int nCount);
+    QJSValue movesToJS(const QVector<Move> &moves) const;
+    QJSValue moveToJS(const Move &move) const;
+    void createBoard();
+    QJSValue columnToJS(const int nX);
+    void updateBoard(const GameState &state);
+    QJSValue fieldToJS(const qint8 nIndex) const;
+    Move moveFromJS(const QJSValue &value, QString *pError) const;
+    bool fieldFromJS(const QJSValue &value, qint8 *pIndex) const;
+    bool fieldFromString(const QString &sField, qint8 *pIndex) const;
+    bool integerFromJS(const QJSValue &value, int *pInt) const;
+    bool fieldIndex(const int nX, const int nY, qint8 *pIndex) const;
+
+    quint8 m_nID;
+    const quint8 m_nNumOfFields;
+    const quint8 m_nHeightTowerWin;
+    QJSEngine *m_jsEngine;
+    QString m_sFilepath;
+    QString m_sSource;
+    bool m_bLoaded;
+    quint32 m_nMemoryLimitMB;
+    bool m_bCollectGarbage;
+    qint64 m_nHeap;  // After the last move, -1 = unknown
+    int m_nHeapCheckCalls;   // See checkHeapLimit()
+    QString m_sMemoryError;  // Limit exceeded during the current call
+    Random m_Random;
+    QMutex m_EngineMutex;  // Engine pointer is also read by interrupt()
+    ScriptStats m_Stats;   // Of the current game, see takeStats()
+    QMutex m_StatsMutex;
+    QJSValue m_obj;
+    QJSValue m_onSetStone;  // Optional callbacks of the script
+    QJSValue m_onMove;
+    QJSValue m_jsBoard;
+    QList<QJSValue> m_jsTowers;  // Tower arrays of m_jsBoard by field index
+    QList<QJSValue> m_jsColumns;
+    QJSValue m_freeze;  // Object.freeze()
+    QVector<quint8> m_nHeights;  // Content of the tower arrays
+    QVector<quint8> m_nColors;
+    GameState m_State;  // Position of the current makeMove() call
+    QElapsedTimer m_MoveTimer;
+    int m_nTargetMs;    // Of the current move, -1 = no game clock
+    QHash<int, ScriptPosition> m_Positions;
+    int m_nNextHandle;
+    QAtomicInt m_Interrupted;  // See interrupt(), reset by startCall()
+    QAtomicInt m_Stopped;      // See stop()
+};
+
+#endif  // SCRIPTRUNNER_H_
@@ -0,0 +1,209 @@
+/**
+ * \file scriptstats.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Timing statistics of CPU scripts.
+ */
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "./scriptstats.h"
+
+namespace {
+const char *const STAGE_NAMES[ScriptStats::NumStages] = {
+  "Board", "Script", "Return", "Callback", "Turn"
+};
+
+QMutex totalsMutex;
+QMap<QString, ScriptStats> totals;
+}  // namespace
+
+ScriptStats::ScriptStats()
+  : m_nLogCalls(0),
+    m_nHelperCalls(0),
+    m_nMaxHeap(-1) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ScriptStats::add(const Stage stage, const qint64 nNsecs) {
+  Histogram &hist(m_Stages[stage]);
+  const qint64 nValue(qMax(Q_INT64_C(0), nNsecs));
+  if (hist.buckets.isEmpty()) {
+    hist.buckets.fill(0, NumBuckets);
+    hist.nMin = nValue;
+    hist.nMax = nValue;
+  }
+  hist.buckets[bucket(nValue)]++;
+  hist.nCount++;
+  hist.nMin = qMin(hist.nMin, nValue);
+  hist.nMax = qMax(hist.nMax, nValue);
+  hist.nSum += nValue;
+}
+
+void ScriptStats::countLog() {
+  m_nLogCalls++;
+}
+
+void ScriptStats::countHelper() {
+  m_nHelperCalls++;
+}
+
+void ScriptStats::addHeap(const qint64 nBytes) {
+  m_nMaxHeap = qMax(m_nMaxHeap, nBytes);
+}
+
+void ScriptStats::merge(const ScriptStats &other) {
+  for (int i = 0; i < NumStages; i++) {
+    const Histogram &src(other.m_Stages[i]);
+    Histogram &dest(m_Stages[i]);
+    if (0 == src.nCount) {
+      continue;
+    }
+    if (0 == dest.nCount) {
+      dest = src;
+      continue;
+    }
+    for (int n = 0; n < NumBuckets; n++) {
+      dest.buckets[n] += src.buckets[n];
+    }
+    dest.nCount += src.nCount;
+    dest.nMin = qMin(dest.nMin, src.nMin);
+    dest.nMax = qMax(dest.nMax, src.nMax);
+    dest.nSum += src.nSum;
+  }
+  m_nLogCalls += other.m_nLogCalls;
+  m_nHelperCalls += other.m_nHelperCalls;
+  m_nMaxHeap = qMax(m_nMaxHeap, other.m_nMaxHeap);
+}
+
+bool ScriptStats::isEmpty() const {
+  for (int i = 0; i < NumStages; i++) {
+    if (0 != m_Stages[i].nCount) {
+      return false;
+    }
+  }
+  return 0 == m_nLogCalls && 0 == m_nHelperCalls;
+}
+
+// ---------------------------------------------------------------------------
+
+// One line per stage, e.g.
+// "Script    n=42  min=1.2ms  median=3.4ms  p99=9.8ms  max=10.1ms  sum=..."
+QString ScriptStats::toString(const QString &sIndent) const {
+  QString sOut;
+  for (int i = 0; i < NumStages; i++) {
+    const Histogram &hist(m_Stages[i]);
+    if (0 == hist.nCount) {
+      continue;
+    }
+    sOut += sIndent + QString(STAGE_NAMES[i]).leftJustified(9) +
+            "n=" + QString::number(hist.nCount) +
+            "  min=" + formatTime(hist.nMin) +
+            "  median=" + formatTime(hist.percentile(0.5)) +
+            "  p99=" + formatTime(hist.percentile(0.99)) +
+            "  max=" + formatTime(hist.nMax) +
+            "  sum=" + formatTime(hist.nSum) + "\n";
+  }
+  sOut += sIndent + "cpu.log() calls: " + QString::number(m_nLogCalls) +
+          ", native helper calls: " + QString::number(m_nHelperCalls);
+  if (m_nMaxHeap >= 0) {
+    sOut += ", max. heap: " + QString::number(m_nMaxHeap / 1024) + " KB";
+  }
+  return sOut;
+}
+
+// ---------------------------------------------------------------------------
+
+// Smallest sample value v with at least dFraction of all samples <= v
+qint64 ScriptStats::Histogram::percentile(const double dFraction) const {
+  if (0 == nCount) {
+    return 0;
+  }
+  const qint64 nRank(qMax(Q_INT64_C(1),
+                          static_cast<qint64>(dFraction * nCount + 0.5)));
+  qint64 nSeen(0);
+  for (int i = 0; i < buckets.size(); i++) {
+    nSeen += buckets[i];
+    if (nSeen >= nRank) {
+      return qBound(nMin, bucketValue(i), nMax);
+    }
+  }
+  return nMax;
+}
+
+// 0..7 exact, above that 8 buckets per power of two
+int ScriptStats::bucket(const qint64 nNsecs) {
+  if (nNsecs < 8) {
+    return static_cast<int>(nNsecs);
+  }
+  int nExp(3);
+  while (nExp < 62 && (nNsecs >> (nExp + 1)) != 0) {
+    nExp++;
+  }
+  return (nExp - 2) * 8 + static_cast<int>((nNsecs >> (nExp - 3)) & 7);
+}
+
+// Middle of the bucket
+qint64 ScriptStats::bucketValue(const int nBucket) {
+  if (nBucket < 8) {
+    return nBucket;
+  }
+  const int nExp(nBucket / 8 + 2);
+  const qint64 nLower(static_cast<qint64>(8 + nBucket % 8) << (nExp - 3));
+  return nLower + ((Q_INT64_C(1) << (nExp - 3)) >> 1);
+}
+
+QString ScriptStats::formatTime(const qint64 nNsecs) {
+  if (nNsecs < 10000) {
+    return QString::number(nNsecs) + "ns";
+  } else if (nNsecs < 10000000) {
+    return QString::number(nNsecs / 1000.0, 'f', 1) + "us";
+  }
+  return QString::number(nNsecs / 1000000.0, 'f', 1) + "ms";
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void ScriptStats::addToTotals(const QString &sScript,
+                              const ScriptStats &stats) {
+  QMutexLocker locker(&totalsMutex);
+  totals[sScript].merge(stats);
+}
+
+void ScriptStats::clearTotals() {
+  QMutexLocker locker(&totalsMutex);
+  totals.clear();
+}
+
+void ScriptStats::printTotals(QTextStream *pOut) {
+  QMutexLocker locker(&totalsMutex);
+  QMap<QString, ScriptStats>::const_iterator it(totals.constBegin());
+  for (; it != totals.constEnd(); ++it) {
+    *pOut << endl << "Timing " << it.key() << ":" << endl
+          << it.value().toString("  ") << endl;
+  }
+}
@@ -0,0 +1,92 @@
+/**
+ * \file scriptstats.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the timing statistics of CPU scripts.
+ */
+
+#ifndef SCRIPTSTATS_H_
+#define SCRIPTSTATS_H_
+
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+
+/**
+ * \class ScriptStats
+ * \brief Timing histograms of the stages of a CPU script move.
+ *
+ * Board: board array update, Script: makeMove() of the script,
+ * Return: conversion and check of the returned move, Callback: onSetStone()
+ * and onMove(), Turn: whole move as seen by the game (incl. thread switch).
+ * Samples are kept in log-linear buckets (8 per power of two), so
+ * percentiles are exact to 12.5%, min and max are exact.
+ */
+class ScriptStats {
+  public:
+    enum Stage { Board = 0, Script, Return, Callback, Turn, NumStages };
+
+    ScriptStats();
+
+    void add(const Stage stage, const qint64 nNsecs);
+    void countLog();
+    void countHelper();
+    void addHeap(const qint64 nBytes);
+    void merge(const ScriptStats &other);
+    bool isEmpty() const;
+    QString toString(const QString &sIndent = QString()) const;
+
+    // Totals per script of all finished games (arena, tournament)
+    static void addToTotals(const QString &sScript, const ScriptStats &stats);
+    static void clearTotals();
+    static void printTotals(QTextStream *pOut);
+
+  private:
+    enum { NumBuckets = 488 };
+
+    /**
+     * \struct Histogram
+     * \brief Samples of one stage in nanoseconds.
+     */
+    struct Histogram {
+      Histogram() : nCount(0), nMin(0), nMax(0), nSum(0) {}
+
+      qint64 percentile(const double dFraction) const;
+
+      QVector<quint32> buckets;  // Allocated with the first sample
+      qint64 nCount;
+      qint64 nMin;
+      qint64 nMax;
+      qint64 nSum;
+    };
+
+    static int bucket(const qint64 nNsecs);
+    static qint64 bucketValue(const int nBucket);
+    static QString formatTime(const qint64 nNsecs);
+
+    Histogram m_Stages[NumStages];
+    qint64 m_nLogCalls;
+    qint64 m_nHelperCalls;
+    qint64 m_nMaxHeap;  // Bytes, -1 = unknown
+};
+
+#endif  // SCRIPTSTATS_H_
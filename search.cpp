@@ -0,0 +1,497 @@
+/**
+ * \file search.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Native iterative deepening alpha-beta search.
+ */
+
+#include <QThread>
+#include <QtAlgorithms>
+
+#include "./search.h"
+
+namespace {
+const int INFINITE_SCORE = Search::WinScore + 1;
+// Value of a tower by height, counted for the owner of the top stone
+const int HEIGHT_VALUE[Position::MaxLevels + 1] = {0, 2, 6, 14, 30};
+const int TOWER_VALUE = 1000;
+const int THREAT_TO_MOVE = 800;
+const int THREAT_WAITING = 150;
+
+// Win scores are stored relative to the position, not to the root
+int scoreToTable(const int nScore, const int nPly) {
+  if (nScore >= Search::WinScore - Search::MaxPly) {
+    return nScore + nPly;
+  } else if (nScore <= Search::MaxPly - Search::WinScore) {
+    return nScore - nPly;
+  }
+  return nScore;
+}
+
+int scoreFromTable(const int nScore, const int nPly) {
+  if (nScore >= Search::WinScore - Search::MaxPly) {
+    return nScore - nPly;
+  } else if (nScore <= Search::MaxPly - Search::WinScore) {
+    return nScore + nPly;
+  }
+  return nScore;
+}
+}  // namespace
+
+/**
+ * \class SearchThread
+ * \brief Runs a helper search of the Lazy SMP search.
+ */
+class SearchThread : public QThread {
+  public:
+    SearchThread(Search *pSearch, const int nStartDepth)
+      : m_pSearch(pSearch),
+        m_nStartDepth(nStartDepth) {
+    }
+
+  protected:
+    void run() {
+      m_pSearch->iterate(m_nStartDepth);
+    }
+
+  private:
+    Search *m_pSearch;
+    const int m_nStartDepth;
+};
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+Search::Search()
+  : m_nMaxDepth(8),
+    m_nTimeMs(1000),
+    m_nTargetMs(0),
+    m_pTable(NULL),
+    m_pTablebase(NULL),
+    m_Stop(0),
+    m_pStop(&m_Stop),
+    m_Abort(0),
+    m_nNodes(0),
+    m_nDepth(0),
+    m_nScore(0) {
+  for (int i = 0; i < MaxPly; i++) {
+    m_Moves[i].reserve(128);
+  }
+}
+
+Search::~Search() {
+  qDeleteAll(m_Helpers);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// nTimeMs is the hard limit; with nTargetMs > 0 the next depth is only
+// started, if it is expected to end within nTargetMs (node growth of the
+// last depth, see iterate())
+void Search::setLimits(const quint8 nMaxDepth, const int nTimeMs,
+                       const int nTargetMs) {
+  m_nMaxDepth = qBound(1, static_cast<int>(nMaxDepth), MaxPly - 1);
+  m_nTimeMs = nTimeMs;
+  m_nTargetMs = nTargetMs;
+}
+
+// Optional, the table can be shared by several searches
+void Search::setTable(TranspositionTable *pTable) {
+  m_pTable = pTable;
+}
+
+// Solved endgame positions, see Retrograde
+void Search::setTablebase(const Tablebase *pTablebase) {
+  m_pTablebase = pTablebase;
+}
+
+// Positions of the game up to the one to be searched
+void Search::setHistory(const History &history) {
+  m_History = history;
+}
+
+// Number of threads incl. the calling one, helpers are created once here
+void Search::setThreads(const quint8 nThreads) {
+  const int nHelpers(qBound(1, static_cast<int>(nThreads),
+                            static_cast<int>(MaxThreads)) - 1);
+  while (m_Helpers.size() > nHelpers) {
+    delete m_Helpers.takeLast();
+  }
+  while (m_Helpers.size() < nHelpers) {
+    Search *pHelper(new Search());
+    pHelper->m_pStop = &m_Stop;
+    m_Helpers << pHelper;
+  }
+}
+
+quint8 Search::getThreads() const {
+  return m_Helpers.size() + 1;
+}
+
+quint8 Search::getDepth() const {
+  return m_nDepth;
+}
+
+int Search::getScore() const {
+  return m_nScore;
+}
+
+qint64 Search::getNodes() const {
+  return m_nNodes;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+Move Search::findBestMove(const GameState &state) {
+  m_State = state;
+  if (m_History.isEmpty() || m_History.last() != state.getKey()) {
+    // No (or an outdated) history given, only the search path is checked
+    m_History.clear();
+    m_History.push(state.getKey());
+  }
+  m_Timer.start();
+  m_Stop.store(0);
+  m_nNodes = 0;
+  m_nDepth = 0;
+  m_nScore = 0;
+  if (NULL != m_pTable) {
+    m_pTable->newSearch();
+  }
+
+  // Helpers are useless without a shared table
+  QList<SearchThread *> threads;
+  if (NULL != m_pTable) {
+    for (int i = 0; i < m_Helpers.size(); i++) {
+      Search *pHelper(m_Helpers[i]);
+      pHelper->m_State = state;
+      pHelper->m_History = m_History;
+      pHelper->m_pTable = m_pTable;
+      pHelper->m_pTablebase = m_pTablebase;
+      pHelper->m_nMaxDepth = m_nMaxDepth;
+      pHelper->m_nTimeMs = 0;  // Stopped by the main search
+      pHelper->m_nTargetMs = 0;
+      pHelper->m_nNodes = 0;
+      // Half of the helpers start one ply deeper to spread the work
+      threads << new SearchThread(pHelper, 2 - (i & 1));
+      threads.last()->start();
+    }
+  }
+
+  const Move bestMove(this->iterate(1));
+
+  m_Stop.store(1);
+  for (int i = 0; i < threads.size(); i++) {
+    threads[i]->wait();
+    m_nNodes += m_Helpers[i]->m_nNodes;
+  }
+  qDeleteAll(threads);
+  return bestMove;
+}
+
+// Called from another thread: the running and all further searches end
+// soon
+void Search::stop() {
+  m_Abort.store(1);
+}
+
+// ---------------------------------------------------------------------------
+
+Move Search::iterate(const int nStartDepth) {
+  QVector<Move> rootMoves;
+  m_State.generateMoves(&rootMoves);
+  if (rootMoves.isEmpty()) {
+    return Move();
+  }
+  this->orderMoves(&rootMoves, Move());
+  Move bestMove(rootMoves.first());
+  if (1 == rootMoves.size()) {
+    return bestMove;
+  }
+
+  GameState::Undo undo;
+  qint64 nLastNodes(0);  // Of the previous iteration
+  for (int nDepth = nStartDepth; nDepth <= m_nMaxDepth; nDepth++) {
+    const qint64 nStartNodes(m_nNodes);
+    this->orderMoves(&rootMoves, bestMove);
+    int nAlpha(-INFINITE_SCORE);
+    Move iterationBest(rootMoves.first());
+
+    for (int i = 0; i < rootMoves.size(); i++) {
+      m_State.applyMove(rootMoves[i], &undo);
+      const int nScore(this->child(nDepth - 1, nAlpha, INFINITE_SCORE, 1));
+      m_State.undoMove(rootMoves[i], undo);
+      if (0 != m_pStop->load()) {
+        break;
+      }
+      if (nScore > nAlpha) {
+        nAlpha = nScore;
+        iterationBest = rootMoves[i];
+      }
+    }
+
+    // Results of an interrupted iteration are not reliable
+    if (0 != m_pStop->load()) {
+      break;
+    }
+    bestMove = iterationBest;
+    m_nDepth = nDepth;
+    m_nScore = nAlpha;
+    if (qAbs(nAlpha) >= WinScore - MaxPly) {  // Forced result found
+      break;
+    }
+
+    // The next depth takes about as many times longer as this one took
+    // compared to the previous one; it is not started, if it would end
+    // after the target time
+    if (m_nTargetMs > 0) {
+      const qint64 nNodes(m_nNodes - nStartNodes);
+      const qint64 nGrowth(qMax(Q_INT64_C(2),
+                                nNodes / qMax(Q_INT64_C(1), nLastNodes)));
+      nLastNodes = nNodes;
+      if (m_Timer.nsecsElapsed() / 1000000.0 * (1 + nGrowth) >=
+          m_nTargetMs) {
+        break;
+      }
+    }
+  }
+
+  return bestMove;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+int Search::negamax(int nDepth, int nAlpha, int nBeta, const int nPly) {
+  m_nNodes++;
+  if (0 == (m_nNodes & 2047) && this->checkTime()) {
+    m_pStop->store(1);
+  }
+  if (0 != m_pStop->load()) {
+    return 0;
+  }
+
+  const quint8 nWinner(m_State.getWinner());
+  if (0 != nWinner) {
+    return (nWinner == m_State.getCurrentPlayer()) ? WinScore - nPly
+                                                    : nPly - WinScore;
+  }
+  if (nDepth <= 0 || nPly >= MaxPly - 1) {
+    return this->evaluate();
+  }
+
+  // Exact result with the distance to the end of the game
+  if (NULL != m_pTablebase) {
+    quint16 nDistance(0);
+    switch (m_pTablebase->probe(m_State, &nDistance)) {
+      case Tablebase::Win:
+        return WinScore - nPly - nDistance;
+      case Tablebase::Loss:
+        return nPly + nDistance - WinScore;
+      case Tablebase::Draw:
+        return 0;
+      default:
+        break;
+    }
+  }
+
+  // Symmetric positions share one entry, its move is stored for the
+  // canonical position
+  quint8 nSymmetry(0);
+  const quint64 nKey(NULL != m_pTable ? m_State.getCanonicalKey(&nSymmetry)
+                                      : 0);
+  TranspositionTable::Entry entry;
+  if (NULL != m_pTable && m_pTable->probe(nKey, &entry)) {
+    entry.move = m_State.transformMove(entry.move,
+                                       MoveTables::inverse(nSymmetry));
+    if (entry.nDepth >= nDepth) {
+      const int nScore(scoreFromTable(entry.nScore, nPly));
+      if (TranspositionTable::ExactBound == entry.bound ||
+          (TranspositionTable::LowerBound == entry.bound && nScore >= nBeta) ||
+          (TranspositionTable::UpperBound == entry.bound && nScore <= nAlpha)) {
+        return nScore;
+      }
+    }
+  }
+
+  QVector<Move> &moves(m_Moves[nPly]);
+  m_State.generateMoves(&moves);
+  if (moves.isEmpty()) {
+    // Pass, if the opponent still can move - otherwise the game is a tie
+    int nScore(0);
+    m_State.passTurn();
+    m_State.generateMoves(&m_Moves[nPly + 1]);
+    if (!m_Moves[nPly + 1].isEmpty()) {
+      nScore = this->child(nDepth - 1, nAlpha, nBeta, nPly + 1);
+    }
+    m_State.passTurn();
+    return nScore;
+  }
+  // Best move of a former search is tried first (if still legal)
+  this->orderMoves(&moves, entry.move);
+
+  const int nAlphaOrig(nAlpha);
+  int nBest(-INFINITE_SCORE);
+  Move bestMove;
+  GameState::Undo undo;
+  for (int i = 0; i < moves.size(); i++) {
+    m_State.applyMove(moves[i], &undo);
+    const int nScore(this->child(nDepth - 1, nAlpha, nBeta, nPly + 1));
+    m_State.undoMove(moves[i], undo);
+    if (0 != m_pStop->load()) {
+      return 0;
+    }
+
+    if (nScore > nBest) {
+      nBest = nScore;
+      bestMove = moves[i];
+      if (nScore > nAlpha) {
+        nAlpha = nScore;
+        if (nAlpha >= nBeta) {
+          break;
+        }
+      }
+    }
+  }
+
+  if (NULL != m_pTable) {
+    TranspositionTable::Entry result;
+    result.move = m_State.transformMove(bestMove, nSymmetry);
+    result.nScore = scoreToTable(nBest, nPly);
+    result.nDepth = nDepth;
+    if (nBest <= nAlphaOrig) {
+      result.bound = TranspositionTable::UpperBound;
+    } else if (nBest >= nBeta) {
+      result.bound = TranspositionTable::LowerBound;
+    } else {
+      result.bound = TranspositionTable::ExactBound;
+    }
+    m_pTable->store(nKey, result);
+  }
+  return nBest;
+}
+
+// Score of the position after a move, seen by the player who made it.
+// A repetition is a tie: the cycle could be left later just as well.
+// The few keys of the search path are compared directly, the history of
+// the game isn't changed during the search.
+int Search::child(const int nDepth, const int nAlpha, const int nBeta,
+                  const int nPly) {
+  const quint64 nKey(m_State.getKey());
+  if (m_History.contains(nKey)) {
+    return 0;
+  }
+  for (int i = 1; i < nPly; i++) {
+    if (nKey == m_nPathKeys[i]) {
+      return 0;
+    }
+  }
+  m_nPathKeys[nPly] = nKey;
+  return -this->negamax(nDepth, -nBeta, -nAlpha, nPly);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+int Search::evaluate() const {
+  const Position &pos(m_State.getPosition());
+  const quint8 nMaxHeight(m_State.getMaxTowerHeight());
+  const quint8 nPlayer(m_State.getCurrentPlayer());
+  int nScore(TOWER_VALUE * (pos.wonTowers(1) - pos.wonTowers(2)));
+  int nThreats[2] = {0, 0};
+
+  quint32 nTowers(pos.occupied());
+  while (0 != nTowers) {
+    const qint8 nTo(qCountTrailingZeroBits(nTowers));
+    nTowers &= nTowers - 1;
+    const quint8 nHeight(pos.height(nTo));
+    nScore += (1 == pos.topStone(nTo)) ? HEIGHT_VALUE[nHeight]
+                                       : -HEIGHT_VALUE[nHeight];
+
+    // Towers, which can be conquered with the next move
+    quint32 nSources(m_State.getSources(nTo));
+    while (0 != nSources) {
+      const qint8 nFrom(qCountTrailingZeroBits(nSources));
+      nSources &= nSources - 1;
+      if (nHeight + pos.height(nFrom) >= nMaxHeight) {
+        nThreats[pos.topStone(nFrom) - 1]++;
+      }
+    }
+  }
+
+  if (2 == nPlayer) {
+    nScore = -nScore;
+  }
+  if (nThreats[nPlayer - 1] > 0) {
+    nScore += THREAT_TO_MOVE;
+  }
+  nScore -= THREAT_WAITING * nThreats[2 - nPlayer];
+  return nScore;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+void Search::orderMoves(QVector<Move> *pMoves, const Move &first) const {
+  // Priority: given move, own conquests, tower moves, set stone, conquests
+  // for the opponent (stable insertion sort, lists are short)
+  const quint8 nMaxHeight(m_State.getMaxTowerHeight());
+  const quint8 nPlayer(m_State.getCurrentPlayer());
+  quint8 nPriority[512];
+  const int nCount(qMin(pMoves->size(), 512));
+  Move *pData(pMoves->data());
+
+  for (int i = 0; i < nCount; i++) {
+    const Move &move(pData[i]);
+    if (move == first) {
+      nPriority[i] = 5;
+    } else if (move.isSetStone()) {
+      nPriority[i] = 2;
+    } else if (m_State.getHeight(move.nTo) + move.nStones >= nMaxHeight) {
+      nPriority[i] = (nPlayer == m_State.getTopStone(move.nFrom)) ? 4 : 1;
+    } else {
+      nPriority[i] = 3;
+    }
+  }
+
+  for (int i = 1; i < nCount; i++) {
+    const Move move(pData[i]);
+    const quint8 nPrio(nPriority[i]);
+    int j(i - 1);
+    while (j >= 0 && nPriority[j] < nPrio) {
+      pData[j + 1] = pData[j];
+      nPriority[j + 1] = nPriority[j];
+      j--;
+    }
+    pData[j + 1] = move;
+    nPriority[j + 1] = nPrio;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool Search::checkTime() {
+  return 0 != m_Abort.load() ||
+      (m_nTimeMs > 0 && m_Timer.elapsed() >= m_nTimeMs);
+}
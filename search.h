@@ -0,0 +1,103 @@
+/**
+ * \file search.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the native alpha-beta search.
+ */
+
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QList>
+#include <QVector>
+
+#include "./gamestate.h"
+#include "./history.h"
+#include "./tablebase.h"
+#include "./transpositiontable.h"
+
+/**
+ * \class Search
+ * \brief Iterative deepening alpha-beta (negamax) search on a GameState.
+ *
+ * With more than one thread (and a transposition table) the search runs
+ * Lazy SMP: helper searches work on the same position in parallel and
+ * only share their results through the table.
+ * Positions, which occurred before in the game or on the current path,
+ * are scored as a tie, so cycles are cut off.
+ * Besides the hard time limit, a target time (from the game clock) stops
+ * iterating early, if the next depth would most likely not finish in time.
+ */
+class Search {
+  public:
+    enum { MaxPly = 64, WinScore = 100000, MaxThreads = 64 };
+
+    Search();
+    ~Search();
+
+    void setLimits(const quint8 nMaxDepth, const int nTimeMs,
+                   const int nTargetMs = 0);
+    void setTable(TranspositionTable *pTable);
+    void setTablebase(const Tablebase *pTablebase);
+    void setHistory(const History &history);
+    void setThreads(const quint8 nThreads);
+    Move findBestMove(const GameState &state);
+    void stop();
+
+    quint8 getDepth() const;
+    int getScore() const;
+    qint64 getNodes() const;
+    quint8 getThreads() const;
+
+  private:
+    friend class SearchThread;
+
+    Move iterate(const int nStartDepth);
+    int negamax(int nDepth, int nAlpha, int nBeta, const int nPly);
+    int child(const int nDepth, const int nAlpha, const int nBeta,
+              const int nPly);
+    int evaluate() const;
+    void orderMoves(QVector<Move> *pMoves, const Move &first) const;
+    bool checkTime();
+
+    quint8 m_nMaxDepth;
+    int m_nTimeMs;
+    int m_nTargetMs;  // 0 = search until m_nTimeMs
+    TranspositionTable *m_pTable;
+    const Tablebase *m_pTablebase;
+    GameState m_State;
+    History m_History;  // Positions of the game up to the root
+    quint64 m_nPathKeys[MaxPly];  // Search path by ply, see child()
+    QVector<Move> m_Moves[MaxPly];
+    QElapsedTimer m_Timer;
+    QAtomicInt m_Stop;
+    QAtomicInt *m_pStop;  // Own flag, or the one of the main search
+    QAtomicInt m_Abort;   // See stop()
+    QList<Search *> m_Helpers;
+    qint64 m_nNodes;
+    quint8 m_nDepth;
+    int m_nScore;
+};
+
+#endif  // SEARCH_H_
@@ -29,7 +29,10 @@
 #include <QDirIterator>
 #include <QIcon>
 #include <QMessageBox>
+#include <QThread>
 
+#include "./opponent.h"
+#include "./scriptrunner.h"
 #include "./settings.h"
 #include "ui_settings.h"
 
@@ -128,33 +131,28 @@ void Settings::searchCpuScripts(const QString &userDataDir) {
   sListAvailableCpu << "Human";
   m_sListCPUs.clear();
   m_sListCPUs << "Human";
-  QDir cpuDir = m_sSharePath;
 
   // Cpu scripts in share folder
-  if (cpuDir.cd("cpu")) {
-    foreach (QFileInfo file, cpuDir.entryInfoList(QDir::Files)) {
-      if ("js" == file.suffix().toLower()) {
-        sListAvailableCpu << file.baseName();
-        m_sListCPUs << file.absoluteFilePath();
-      }
-    }
+  foreach (const QString &sScript, Opponent::findCpuScripts(m_sSharePath)) {
+    sListAvailableCpu << QFileInfo(sScript).baseName();
+    m_sListCPUs << sScript;
   }
+
+  // Native alpha-beta and Monte Carlo tree search opponents
+  sListAvailableCpu << "NativeCPU" << "MctsCPU";
+  m_sListCPUs << "NativeCPU" << "MctsCPU";
+
   m_pUi->cbP1HumanCpu->addItems(sListAvailableCpu);
   m_pUi->cbP2HumanCpu->addItems(sListAvailableCpu);
 
   // Cpu scripts in user folder
-  cpuDir = userDataDir;
-  if (cpuDir.cd("cpu")) {
-    foreach (QFileInfo file, cpuDir.entryInfoList(QDir::Files)) {
-      if ("js" == file.suffix().toLower()) {
-        sListAvailableCpu << file.baseName();
-        m_pUi->cbP1HumanCpu->addItem(QIcon(":/images/user.png"),
-                                     sListAvailableCpu.last());
-        m_pUi->cbP2HumanCpu->addItem(QIcon(":/images/user.png"),
-                                     sListAvailableCpu.last());
-        m_sListCPUs << file.absoluteFilePath();
-      }
-    }
+  foreach (const QString &sScript, Opponent::findCpuScripts(userDataDir)) {
+    sListAvailableCpu << QFileInfo(sScript).baseName();
+    m_pUi->cbP1HumanCpu->addItem(QIcon(":/images/user.png"),
+                                 sListAvailableCpu.last());
+    m_pUi->cbP2HumanCpu->addItem(QIcon(":/images/user.png"),
+                                 sListAvailableCpu.last());
+    m_sListCPUs << sScript;
   }
 }
 
@@ -189,6 +187,15 @@ void Settings::accept() {
   m_bShowPossibleMoveTowers = m_pUi->checkShowPossibleMoves->isChecked();
   m_pSettings->setValue("ShowPossibleMoveTowers", m_bShowPossibleMoveTowers);
 
+  m_nSearchDepth = m_pUi->spinSearchDepth->value();
+  m_pSettings->setValue("SearchDepth", m_nSearchDepth);
+  m_nSearchTime = m_pUi->spinSearchTime->value();
+  m_pSettings->setValue("SearchTime", m_nSearchTime);
+  m_nSearchThreads = m_pUi->spinSearchThreads->value();
+  m_pSettings->setValue("SearchThreads", m_nSearchThreads);
+  m_nScriptTimeLimit = m_pUi->spinScriptTimeLimit->value();
+  m_pSettings->setValue("ScriptTimeLimit", m_nScriptTimeLimit);
+
   m_pSettings->beginGroup("Colors");
   m_pSettings->setValue("BgColor", m_bgColor.name());
   m_pSettings->setValue("HighlightColor", m_highlightColor.name());
@@ -296,6 +303,44 @@ void Settings::readSettings() {
                                                  true).toBool();
   m_pUi->checkShowPossibleMoves->setChecked(m_bShowPossibleMoveTowers);
 
+  m_nSearchDepth = m_pSettings->value("SearchDepth", 8).toUInt();
+  m_pUi->spinSearchDepth->setValue(m_nSearchDepth);
+  m_nSearchDepth = m_pUi->spinSearchDepth->value();
+  m_nSearchTime = m_pSettings->value("SearchTime", 1000).toUInt();
+  m_pUi->spinSearchTime->setValue(m_nSearchTime);
+  m_nSearchTime = m_pUi->spinSearchTime->value();
+  m_nSearchThreads = m_pSettings->value(
+                       "SearchThreads", QThread::idealThreadCount()).toUInt();
+  m_pUi->spinSearchThreads->setValue(m_nSearchThreads);
+  m_nSearchThreads = m_pUi->spinSearchThreads->value();
+  m_nScriptTimeLimit = m_pSettings->value("ScriptTimeLimit", 10000).toUInt();
+  m_pUi->spinScriptTimeLimit->setValue(m_nScriptTimeLimit);
+  m_nScriptTimeLimit = m_pUi->spinScriptTimeLimit->value();
+  // Expert settings, only available in the config file
+  m_nSearchHashSize = m_pSettings->value("SearchHashSize", 32).toUInt();
+  m_nSearchHashReplacement = m_pSettings->value("SearchHashReplacement",
+                                                2).toUInt();
+  m_nScriptMemoryLimit = m_pSettings->value("ScriptMemoryLimit", 0).toUInt();
+  if (0 != m_nScriptMemoryLimit && !ScriptRunner::canMeasureHeap()) {
+    qWarning() << "ScriptMemoryLimit has no effect, this build can't measure"
+               << "the JS heap (private QtQml headers missing)";
+  }
+  m_bScriptGarbageCollection = m_pSettings->value("ScriptGarbageCollection",
+                                                  false).toBool();
+  m_sTablebase = m_pSettings->value("Tablebase", "").toString();
+  m_sOpeningBook = m_pSettings->value("OpeningBook", "").toString();
+  m_nDrawRepetitions = m_pSettings->value("DrawRepetitions", 3).toUInt();
+  if (0 != m_nDrawRepetitions) {  // 0 = no tie by repetition
+    m_nDrawRepetitions = qBound(2, static_cast<int>(m_nDrawRepetitions), 255);
+  }
+  m_nMaxGamePlies = qBound(1u, m_pSettings->value("MaxGamePlies",
+                                                  1000).toUInt(), 65535u);
+  // Game clock in ms, 0 = no clock
+  m_nClockTime = qBound(0, m_pSettings->value("ClockTime", 0).toInt(),
+                        36000000);
+  m_nClockIncrement = qBound(0, m_pSettings->value("ClockIncrement",
+                                                   0).toInt(), 600000);
+
   m_bgColor = this->readColor("BgColor", "#EEEEEC");
   m_highlightColor = this->readColor("HighlightColor", "#8ae234");
   m_highlightBorderColor = this->readColor("HighlightBorderColor", "#888A85");
@@ -382,6 +427,48 @@ quint8 Settings::getWinTowers() const {
 bool Settings::getShowPossibleMoveTowers() const {
   return m_bShowPossibleMoveTowers;
 }
+quint8 Settings::getSearchDepth() const {
+  return m_nSearchDepth;
+}
+int Settings::getSearchTime() const {
+  return m_nSearchTime;
+}
+quint8 Settings::getSearchThreads() const {
+  return m_nSearchThreads;
+}
+quint32 Settings::getSearchHashSize() const {
+  return m_nSearchHashSize;
+}
+quint8 Settings::getSearchHashReplacement() const {
+  return m_nSearchHashReplacement;
+}
+int Settings::getScriptTimeLimit() const {
+  return m_nScriptTimeLimit;
+}
+quint32 Settings::getScriptMemoryLimit() const {
+  return m_nScriptMemoryLimit;
+}
+bool Settings::getScriptGarbageCollection() const {
+  return m_bScriptGarbageCollection;
+}
+QString Settings::getTablebase() const {
+  return m_sTablebase;
+}
+QString Settings::getOpeningBook() const {
+  return m_sOpeningBook;
+}
+quint8 Settings::getDrawRepetitions() const {
+  return m_nDrawRepetitions;
+}
+quint16 Settings::getMaxGamePlies() const {
+  return m_nMaxGamePlies;
+}
+int Settings::getClockTime() const {
+  return m_nClockTime;
+}
+int Settings::getClockIncrement() const {
+  return m_nClockIncrement;
+}
 
 QString Settings::getP1HumanCpu() const {
   if (-1 != m_pUi->cbP1HumanCpu->findText(m_sP1HumanCpu)) {
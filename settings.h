@@ -55,6 +55,20 @@ class Settings : public QDialog {
     quint8 getStartPlayer() const;
     quint8 getWinTowers() const;
     bool getShowPossibleMoveTowers() const;
+    quint8 getSearchDepth() const;
+    int getSearchTime() const;
+    quint8 getSearchThreads() const;
+    quint32 getSearchHashSize() const;
+    quint8 getSearchHashReplacement() const;
+    int getScriptTimeLimit() const;
+    quint32 getScriptMemoryLimit() const;
+    bool getScriptGarbageCollection() const;
+    QString getTablebase() const;
+    QString getOpeningBook() const;
+    quint8 getDrawRepetitions() const;
+    quint16 getMaxGamePlies() const;
+    int getClockTime() const;
+    int getClockIncrement() const;
     QString getLanguage();
 
     QColor getBgColor() const;
@@ -99,6 +113,20 @@ class Settings : public QDialog {
     int m_nStartPlayer;
     int m_nWinTowers;
     bool m_bShowPossibleMoveTowers;
+    int m_nSearchDepth;
+    int m_nSearchTime;
+    int m_nSearchThreads;
+    quint32 m_nSearchHashSize;
+    quint8 m_nSearchHashReplacement;
+    int m_nScriptTimeLimit;
+    quint32 m_nScriptMemoryLimit;
+    bool m_bScriptGarbageCollection;
+    QString m_sTablebase;
+    QString m_sOpeningBook;
+    quint8 m_nDrawRepetitions;
+    quint16 m_nMaxGamePlies;
+    int m_nClockTime;
+    int m_nClockIncrement;
 
     QColor m_bgColor;
     QColor m_highlightColor;
@@ -57,10 +57,6 @@ StackAndConquer::StackAndConquer(const QDir &sharePath,
   this->setupMenu();
   this->setupGraphView();
 
-  // Seed random number generator
-  QTime time = QTime::currentTime();
-  qsrand((uint)time.msec());
-
   this->checkCmdArgs();
 }
 
@@ -71,10 +67,27 @@ StackAndConquer::~StackAndConquer() {
 // ---------------------------------------------------------------------------
 
 void StackAndConquer::checkCmdArgs() {
+  // Same seed = same start players and same random moves of the CPUs
+  m_Random.seed(Random::timeSeed());
+  const int nSeedArg(qApp->arguments().indexOf("--seed"));
+  if (nSeedArg > 0 && nSeedArg + 1 < qApp->arguments().size()) {
+    bool bOk(false);
+    const quint64 nSeed(qApp->arguments()[nSeedArg + 1].toULongLong(&bOk));
+    if (bOk) {
+      m_Random.seed(nSeed);
+    } else {
+      qWarning() << "Invalid seed:" << qApp->arguments()[nSeedArg + 1];
+    }
+  }
+
   // Choose CPU script(s) or load game from command line
   QStringList sListArgs;
   if (qApp->arguments().size() > 1) {
     for (int i = 1; i < qApp->arguments().size(); i++) {
+      if (i == nSeedArg) {
+        i++;  // Skip seed value
+        continue;
+      }
       // Load save game
       if (qApp->arguments()[i].endsWith(".stacksav", Qt::CaseInsensitive)) {
         if (QFile::exists(qApp->arguments()[i])) {
@@ -104,6 +117,13 @@ void StackAndConquer::checkCmdArgs() {
           sListArgs.clear();
           break;
         }
+      } else if ("NativeCPU" == qApp->arguments()[i] ||
+                 "MctsCPU" == qApp->arguments()[i]) {
+        // Built-in native opponents
+        if (2 == sListArgs.size()) {
+          break;
+        }
+        sListArgs << qApp->arguments()[i];
       }
     }
   }
@@ -224,7 +244,7 @@ void StackAndConquer::startNewGame(const QStringList sListArgs) {
   if (NULL != m_pGame) {
     delete m_pGame;
   }
-  m_pGame = new Game(m_pSettings, sListArgs);
+  m_pGame = new Game(m_pSettings, sListArgs, m_Random.next());
 
   connect(m_pGame, SIGNAL(updateNameP1(QString)),
           m_plblPlayer1, SLOT(setText(QString)));
@@ -245,6 +265,8 @@ void StackAndConquer::startNewGame(const QStringList sListArgs) {
           this, SLOT(setViewInteractive(bool)));
   connect(m_pGame, SIGNAL(highlightActivePlayer(bool, bool, bool)),
           this, SLOT(highlightActivePlayer(bool, bool, bool)));
+  connect(m_pGame, SIGNAL(cpuError(QString)),
+          m_pUi->statusBar, SLOT(showMessage(QString)));
 
   m_pGraphView->setScene(m_pGame->getScene());
   m_pGraphView->updateSceneRect(m_pGame->getSceneRect());
@@ -256,7 +278,7 @@ void StackAndConquer::startNewGame(const QStringList sListArgs) {
                          trUtf8("An error occured during CPU initialization."));
     return;
   }
-  m_pGame->updatePlayers(true);
+  m_pGame->updatePlayers();
 }
 
 // ---------------------------------------------------------------------------
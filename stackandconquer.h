@@ -92,6 +92,7 @@ class StackAndConquer : public QMainWindow {
     Settings *m_pSettings;
     QGraphicsView *m_pGraphView;
     Game *m_pGame;
+    Random m_Random;  // Seeds of the games
 
     QFrame *m_pFrame;
     QGridLayout *m_pLayout;
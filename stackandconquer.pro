@@ -42,17 +42,72 @@ QT           += core gui svg qml widgets
 SOURCES      += main.cpp\
                 stackandconquer.cpp \
                 game.cpp \
+                gamestate.cpp \
+                history.cpp \
+                clock.cpp \
+                movetables.cpp \
+                zobrist.cpp \
+                transpositiontable.cpp \
                 board.cpp \
                 player.cpp \
                 settings.cpp \
-                opponentjs.cpp
+                search.cpp \
+                tablebase.cpp \
+                retrograde.cpp \
+                openingbook.cpp \
+                bookbuilder.cpp \
+                mcts.cpp \
+                random.cpp \
+                opponent.cpp \
+                opponentjs.cpp \
+                scriptrunner.cpp \
+                scriptpool.cpp \
+                scriptstats.cpp \
+                enginerunner.cpp \
+                opponentnative.cpp \
+                opponentmcts.cpp \
+                perft.cpp \
+                arena.cpp \
+                tournament.cpp
 
 HEADERS      += stackandconquer.h \
                 game.h \
+                gamestate.h \
+                history.h \
+                clock.h \
+                movetables.h \
+                position.h \
+                zobrist.h \
+                transpositiontable.h \
                 board.h \
                 player.h \
                 settings.h \
-                opponentjs.h
+                search.h \
+                tablebase.h \
+                retrograde.h \
+                openingbook.h \
+                bookbuilder.h \
+                mcts.h \
+                random.h \
+                opponent.h \
+                opponentjs.h \
+                scriptrunner.h \
+                scriptpool.h \
+                scriptstats.h \
+                enginerunner.h \
+                opponentnative.h \
+                opponentmcts.h \
+                perft.h \
+                arena.h \
+                tournament.h
+
+# Heap size of the CPU scripts, only with the private QtQml headers (e.g.
+# Debian/Ubuntu: qtdeclarative5-private-dev); without them the script
+# memory limit has no effect and a warning is printed
+exists($$[QT_INSTALL_HEADERS]/QtQml/$$QT_VERSION/QtQml/private/qv4mm_p.h) {
+  QT         += qml-private
+  DEFINES    += HAVE_QML_PRIVATE
+}
 
 FORMS        += stackandconquer.ui \
                 settings.ui
@@ -0,0 +1,199 @@
+/**
+ * \file tablebase.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Endgame tablebase, memory mapped.
+ */
+
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+
+#include "./tablebase.h"
+
+namespace {
+const char MAGIC[8] = {'S', 'A', 'C', 'T', 'B', '0', '0', '2'};
+const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+QMutex tablesMutex;
+QHash<QString, Tablebase *> tables;  // Also failed files (NULL)
+
+void deleteTables() {
+  QMutexLocker locker(&tablesMutex);
+  qDeleteAll(tables);
+  tables.clear();
+}
+}  // namespace
+
+Tablebase::Tablebase()
+  : m_pKeys(NULL),
+    m_pValues(NULL) {
+  memset(&m_Header, 0, sizeof(m_Header));
+}
+
+Tablebase::~Tablebase() {
+  m_File.close();  // Unmaps the file
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Opened only once per file and shared by all opponents; NULL if the file
+// is missing or invalid
+const Tablebase *Tablebase::open(const QString &sFile) {
+  if (sFile.isEmpty()) {
+    return NULL;
+  }
+  QMutexLocker locker(&tablesMutex);
+  if (tables.contains(sFile)) {
+    return tables.value(sFile);
+  }
+  if (tables.isEmpty()) {
+    qAddPostRoutine(deleteTables);
+  }
+
+  Tablebase *pTable(new Tablebase());
+  if (!pTable->map(sFile)) {
+    delete pTable;
+    pTable = NULL;
+  } else {
+    qDebug() << "Tablebase" << sFile << "-" << pTable->size() << "positions";
+  }
+  tables.insert(sFile, pTable);
+  return pTable;
+}
+
+bool Tablebase::map(const QString &sFile) {
+  m_File.setFileName(sFile);
+  if (!m_File.open(QIODevice::ReadOnly)) {
+    qWarning() << "Couldn't open tablebase:" << sFile;
+    return false;
+  }
+  if (m_File.read(reinterpret_cast<char *>(&m_Header), sizeof(m_Header)) !=
+      sizeof(m_Header) ||
+      0 != memcmp(m_Header.sMagic, MAGIC, sizeof(MAGIC)) ||
+      BYTE_ORDER_MARK != m_Header.nByteOrder) {
+    qWarning() << "Invalid tablebase (or other byte order):" << sFile;
+    return false;
+  }
+  Header check;
+  fillHeader(&check, GameState(), 0);
+  if (check.nCheckKey != m_Header.nCheckKey) {
+    qWarning() << "Tablebase was generated with other hash keys:" << sFile;
+    return false;
+  }
+
+  const qint64 nSize(sizeof(Header) + static_cast<qint64>(m_Header.nCount) *
+                     (sizeof(quint64) + sizeof(quint16)));
+  if (m_File.size() != nSize) {
+    qWarning() << "Tablebase size doesn't match:" << sFile;
+    return false;
+  }
+  const uchar *pData(m_File.map(0, nSize));
+  if (NULL == pData) {
+    qWarning() << "Couldn't map tablebase:" << sFile;
+    return false;
+  }
+  m_pKeys = reinterpret_cast<const quint64 *>(pData + sizeof(Header));
+  m_pValues = reinterpret_cast<const quint16 *>(m_pKeys + m_Header.nCount);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool Tablebase::write(const QString &sFile, const GameState &rules,
+                      QVector<Entry> *pEntries) {
+  qSort(pEntries->begin(), pEntries->end());
+  Header header;
+  fillHeader(&header, rules, pEntries->size());
+
+  QFile file(sFile);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Couldn't write tablebase:" << sFile;
+    return false;
+  }
+  QVector<quint64> keys(pEntries->size());
+  QVector<quint16> values(pEntries->size());
+  for (int i = 0; i < pEntries->size(); i++) {
+    keys[i] = pEntries->at(i).nKey;
+    values[i] = pEntries->at(i).nValue;
+  }
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(keys.constData()),
+             keys.size() * sizeof(quint64));
+  file.write(reinterpret_cast<const char *>(values.constData()),
+             values.size() * sizeof(quint16));
+  file.close();
+  return QFile::NoError == file.error();
+}
+
+void Tablebase::fillHeader(Header *pHeader, const GameState &rules,
+                           const quint32 nCount) {
+  memset(pHeader, 0, sizeof(Header));
+  memcpy(pHeader->sMagic, MAGIC, sizeof(MAGIC));
+  pHeader->nByteOrder = BYTE_ORDER_MARK;
+  pHeader->nCount = nCount;
+  pHeader->nCheckKey = Zobrist::tower(0, 1, 0) ^ Zobrist::side();
+  pHeader->nNumOfFields = rules.getNumOfFields();
+  pHeader->nMaxTowerHeight = rules.getMaxTowerHeight();
+  pHeader->nMaxStones = rules.getMaxStones();
+  pHeader->nWinTowers = rules.getWinTowers();
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Lower 2 bits: value, upper 14 bits: distance in plies
+quint16 Tablebase::pack(const Value value, const quint16 nDistance) {
+  return static_cast<quint16>((qMin(nDistance, quint16(0x3FFF)) << 2) |
+                              value);
+}
+
+Tablebase::Value Tablebase::probe(const GameState &state,
+                                  quint16 *pDistance) const {
+  if (0 == m_Header.nCount ||
+      state.getNumOfFields() != m_Header.nNumOfFields ||
+      state.getMaxTowerHeight() != m_Header.nMaxTowerHeight ||
+      state.getMaxStones() != m_Header.nMaxStones ||
+      state.getWinTowers() != m_Header.nWinTowers) {
+    return Unknown;
+  }
+
+  const quint64 nKey(state.getCanonicalKey());
+  const quint64 *pEnd(m_pKeys + m_Header.nCount);
+  const quint64 *pFound(qLowerBound(m_pKeys, pEnd, nKey));
+  if (pEnd == pFound || *pFound != nKey) {
+    return Unknown;
+  }
+  const quint16 nValue(m_pValues[pFound - m_pKeys]);
+  *pDistance = nValue >> 2;
+  return static_cast<Value>(nValue & 3);
+}
+
+quint32 Tablebase::size() const {
+  return m_Header.nCount;
+}
@@ -0,0 +1,102 @@
+/**
+ * \file tablebase.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the endgame tablebase.
+ */
+
+#ifndef TABLEBASE_H_
+#define TABLEBASE_H_
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "./gamestate.h"
+
+/**
+ * \class Tablebase
+ * \brief Memory mapped table of solved positions (see Retrograde).
+ *
+ * File: Header, sorted canonical Zobrist keys (quint64, only one of the
+ * symmetric positions is stored), values (quint16) in the byte order of
+ * the generating machine. A value holds the result for the
+ * player to move and the distance in plies to the end of the game.
+ * Positions not in the table are Unknown, not a draw.
+ */
+class Tablebase {
+  public:
+    enum Value { Unknown = 0, Win, Loss, Draw };
+
+    /**
+     * \struct Entry
+     * \brief Solved position, as written by the generator.
+     */
+    struct Entry {
+      Entry() : nKey(0), nValue(0) {}
+      Entry(const quint64 key, const Value value, const quint16 nDistance)
+        : nKey(key), nValue(pack(value, nDistance)) {}
+      bool operator<(const Entry &other) const { return nKey < other.nKey; }
+
+      quint64 nKey;
+      quint16 nValue;
+    };
+
+    ~Tablebase();
+    static const Tablebase *open(const QString &sFile);
+    static bool write(const QString &sFile, const GameState &rules,
+                      QVector<Entry> *pEntries);
+    Value probe(const GameState &state, quint16 *pDistance) const;
+    quint32 size() const;
+
+  private:
+    Q_DISABLE_COPY(Tablebase)
+
+    /**
+     * \struct Header
+     * \brief Start of the file, the rules have to match the probed game.
+     */
+    struct Header {
+      char sMagic[8];
+      quint32 nByteOrder;
+      quint32 nCount;
+      quint64 nCheckKey;   // Same Zobrist keys as the generator
+      quint8 nNumOfFields;
+      quint8 nMaxTowerHeight;
+      quint8 nMaxStones;
+      quint8 nWinTowers;
+      quint32 nReserved;
+    };
+
+    Tablebase();
+    bool map(const QString &sFile);
+    static quint16 pack(const Value value, const quint16 nDistance);
+    static void fillHeader(Header *pHeader, const GameState &rules,
+                           const quint32 nCount);
+
+    QFile m_File;
+    Header m_Header;
+    const quint64 *m_pKeys;
+    const quint16 *m_pValues;
+};
+
+#endif  // TABLEBASE_H_
@@ -0,0 +1,36 @@
+/**
+ * \file ThrowInOnMove.js
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Test CPU for arena_callback_error.sh: plays the first legal move and
+ * throws in the onMove() callback, i.e. after the first tower was moved
+ * (by either player). The game has to be lost by this script, also if the
+ * exception is reported while the opponent is thinking.
+ */
+
+function makeMove(nPossibleMove) {
+  return cpu.legalMoves(0)[0];
+}
+
+function onMove(from, to, nStones, nPlayer) {
+  throw new Error("onMove() test exception");
+}
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Arena test: an exception in a move callback of a script loses the game
+# for the script, not for the opponent who is to move at that time.
+# Usage: tests/arena_callback_error.sh <path of the stackandconquer binary>
+
+BIN=${1:-./stackandconquer}
+SCRIPT="$(cd "$(dirname "$0")" && pwd)/arena/ThrowInOnMove.js"
+GAMES=4
+
+# $1, $2 = CPUs, $3 = expected result, $4 = expected error player
+check() {
+  OUT=$("$BIN" --arena $GAMES "$1" "$2" --depth 2 --seed 1 2>/dev/null)
+  if [ "$(echo "$OUT" | grep -c '^Game ')" -ne $GAMES ]; then
+    echo "FAIL: $1 - $2: not all games played"
+    echo "$OUT"
+    exit 1
+  fi
+  if echo "$OUT" | grep '^Game ' | grep -v " $3 .*error $4" > /dev/null; then
+    echo "FAIL: $1 - $2: expected $3 and error $4 in every game"
+    echo "$OUT"
+    exit 1
+  fi
+  echo "OK: $1 - $2"
+}
+
+check "$SCRIPT" NativeCPU "0-1" P1
+check NativeCPU "$SCRIPT" "1-0" P2
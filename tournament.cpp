@@ -0,0 +1,202 @@
+/**
+ * \file tournament.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Parallel CPU tournaments.
+ */
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QtAlgorithms>
+
+#include "./random.h"
+#include "./scriptstats.h"
+#include "./tournament.h"
+
+/**
+ * \class TournamentGame
+ * \brief One game of a tournament, executed by the thread pool.
+ */
+class TournamentGame : public QRunnable {
+  public:
+    TournamentGame(Tournament *pTournament, const int nCpu1, const int nCpu2,
+                   const quint8 nStartPlayer, const quint64 nSeed)
+      : m_pTournament(pTournament),
+        m_nCpu1(nCpu1),
+        m_nCpu2(nCpu2),
+        m_nStartPlayer(nStartPlayer),
+        m_nSeed(nSeed) {
+    }
+
+    void run() {
+      // Created on the worker thread, so are the opponents and JS engines
+      Arena arena(m_pTournament->m_Options, m_pTournament->m_nWinTowers);
+      const Arena::Result result(
+            arena.playGame(m_pTournament->m_sListCpus[m_nCpu1],
+                           m_pTournament->m_sListCpus[m_nCpu2],
+                           m_nStartPlayer, m_nSeed));
+      m_pTournament->addResult(m_nCpu1, m_nCpu2, result, m_nStartPlayer);
+    }
+
+  private:
+    Tournament *m_pTournament;
+    const int m_nCpu1;
+    const int m_nCpu2;
+    const quint8 m_nStartPlayer;
+    const quint64 m_nSeed;
+};
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+Tournament::Tournament(const Opponent::Options &options,
+                       const quint8 nWinTowers)
+  : m_Options(options),
+    m_nWinTowers(nWinTowers),
+    m_pOut(NULL),
+    m_pBook(NULL),
+    m_nFinished(0),
+    m_nTotal(0) {
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// nGames per pairing (start player alternates); gauntlet: first CPU
+// against all others, round robin: everybody against everybody.
+// Games without error are added to pBook (optional).
+void Tournament::run(const QStringList &sListCpus, const Mode mode,
+                     const int nGames, const int nJobs, QTextStream *pOut,
+                     BookBuilder *pBook) {
+  m_sListCpus = sListCpus;
+  m_pOut = pOut;
+  m_pBook = pBook;
+  m_nFinished = 0;
+  m_Standings.clear();
+  ScriptStats::clearTotals();
+  foreach (const QString &sCpu, m_sListCpus) {
+    m_Standings << Standing();
+    m_Standings.last().sName = Arena::cpuName(sCpu);
+  }
+
+  // Seeds are assigned in creation order, independent of the thread timing
+  Random random(m_Options.nSeed);
+  QList<TournamentGame *> games;
+  for (int i = 0; i < m_sListCpus.size(); i++) {
+    for (int j = i + 1; j < m_sListCpus.size(); j++) {
+      if (Gauntlet == mode && 0 != i) {
+        break;
+      }
+      for (int n = 0; n < nGames; n++) {
+        games << new TournamentGame(this, i, j, 1 + (n & 1), random.next());
+      }
+    }
+  }
+  m_nTotal = games.size();
+
+  // Both players of a game may use the same script
+  Arena(m_Options, m_nWinTowers).warmUp(m_sListCpus, 2 * qMax(1, nJobs));
+
+  QElapsedTimer timer;
+  timer.start();
+  QThreadPool pool;
+  pool.setMaxThreadCount(qMax(1, nJobs));
+  *m_pOut << m_nTotal << " games on " << pool.maxThreadCount()
+          << " threads, seed " << m_Options.nSeed << endl;
+  foreach (TournamentGame *pGame, games) {
+    pool.start(pGame);  // Deleted by the pool (autoDelete)
+  }
+  pool.waitForDone();
+
+  const qint64 nElapsed(qMax(Q_INT64_C(1), timer.elapsed()));
+  this->printStandings();
+  *m_pOut << "Time: " << nElapsed << " ms ("
+          << m_nTotal * 1000.0 / nElapsed << " games/s)" << endl;
+  ScriptStats::printTotals(m_pOut);
+}
+
+// ---------------------------------------------------------------------------
+
+void Tournament::addResult(const int nCpu1, const int nCpu2,
+                           const Arena::Result &result,
+                           const quint8 nStartPlayer) {
+  QMutexLocker locker(&m_Mutex);
+  Standing &p1(m_Standings[nCpu1]);
+  Standing &p2(m_Standings[nCpu2]);
+  p1.nGames++;
+  p2.nGames++;
+  p1.nPlies += result.nPlies;
+  p2.nPlies += result.nPlies;
+  if (0 == result.nWinner) {
+    p1.nTies++;
+    p2.nTies++;
+  } else if (1 == result.nWinner) {
+    p1.nWins++;
+    p2.nLosses++;
+  } else {
+    p2.nWins++;
+    p1.nLosses++;
+  }
+  if (1 == result.nErrorPlayer) {
+    p1.nErrors++;
+  } else if (2 == result.nErrorPlayer) {
+    p2.nErrors++;
+  } else if (NULL != m_pBook) {
+    m_pBook->addGame(nStartPlayer, result.moves, result.nWinner);
+  }
+
+  m_nFinished++;
+  *m_pOut << "Game " << m_nFinished << "/" << m_nTotal << ": "
+          << Arena::resultToString(p1.sName, p2.sName, result, nStartPlayer)
+          << endl;
+}
+
+// ---------------------------------------------------------------------------
+
+bool Tournament::higherScore(const Standing &s1, const Standing &s2) {
+  // Same order as the points (win = 1, tie = 1/2)
+  return 2 * s1.nWins + s1.nTies > 2 * s2.nWins + s2.nTies;
+}
+
+void Tournament::printStandings() const {
+  QList<Standing> standings(m_Standings);
+  qStableSort(standings.begin(), standings.end(), higherScore);
+
+  *m_pOut << endl
+          << "Rank  CPU                   Points   Won  Lost   Tie  Errors"
+             "  Avg. plies" << endl;
+  for (int i = 0; i < standings.size(); i++) {
+    const Standing &s(standings[i]);
+    *m_pOut << QString::number(i + 1).leftJustified(6)
+            << s.sName.leftJustified(20, ' ', true)
+            << QString::number(s.nWins + 0.5 * s.nTies).rightJustified(8)
+            << QString::number(s.nWins).rightJustified(6)
+            << QString::number(s.nLosses).rightJustified(6)
+            << QString::number(s.nTies).rightJustified(6)
+            << QString::number(s.nErrors).rightJustified(8)
+            << QString::number(static_cast<double>(s.nPlies) /
+                               qMax(1, s.nGames), 'f', 1).rightJustified(12)
+            << endl;
+  }
+}
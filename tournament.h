@@ -0,0 +1,89 @@
+/**
+ * \file tournament.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for parallel CPU tournaments.
+ */
+
+#ifndef TOURNAMENT_H_
+#define TOURNAMENT_H_
+
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+#include <QTextStream>
+
+#include "./arena.h"
+
+/**
+ * \class Tournament
+ * \brief Round robin or gauntlet between CPUs, games run on a thread pool.
+ *
+ * Every game is a job of its own: it creates an Arena and both opponents
+ * (i.e. its own QJSEngines) on the worker thread, which runs it.
+ * Results are collected into a common standings table.
+ */
+class Tournament {
+  public:
+    enum Mode { RoundRobin = 0, Gauntlet };
+
+    Tournament(const Opponent::Options &options, const quint8 nWinTowers);
+    void run(const QStringList &sListCpus, const Mode mode, const int nGames,
+             const int nJobs, QTextStream *pOut, BookBuilder *pBook = NULL);
+
+  private:
+    friend class TournamentGame;
+
+    /**
+     * \struct Standing
+     * \brief Accumulated results of one participant.
+     */
+    struct Standing {
+      Standing()
+        : nWins(0), nLosses(0), nTies(0), nErrors(0), nGames(0), nPlies(0) {}
+
+      QString sName;
+      int nWins;
+      int nLosses;
+      int nTies;
+      int nErrors;
+      int nGames;
+      qint64 nPlies;
+    };
+
+    void addResult(const int nCpu1, const int nCpu2,
+                   const Arena::Result &result, const quint8 nStartPlayer);
+    void printStandings() const;
+    static bool higherScore(const Standing &s1, const Standing &s2);
+
+    const Opponent::Options m_Options;
+    const quint8 m_nWinTowers;
+    QStringList m_sListCpus;
+    QList<Standing> m_Standings;
+    QMutex m_Mutex;
+    QTextStream *m_pOut;
+    BookBuilder *m_pBook;
+    int m_nFinished;
+    int m_nTotal;
+};
+
+#endif  // TOURNAMENT_H_
@@ -0,0 +1,206 @@
+/**
+ * \file transpositiontable.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Search transposition table.
+ */
+
+#include "./transpositiontable.h"
+
+// Packed slot data (64 bit):
+// score 0-31 | from 32-39 | to 40-47 | stones 48-51 | depth 52-57 |
+// bound 58-59 | age 60-63
+// A slot with data 0 is empty (stored entries always have a bound).
+
+TranspositionTable::TranspositionTable(const quint32 nSizeMB,
+                                       const Replacement replacement)
+  : m_pSlots(NULL),
+    m_nSlots(0),
+    m_nBucketMask(0),
+    m_Replacement(replacement),
+    m_nAge(0) {
+  this->resize(nSizeMB);
+}
+
+TranspositionTable::~TranspositionTable() {
+  delete [] m_pSlots;
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+// Not thread safe - only to be called while no search is running
+void TranspositionTable::resize(const quint32 nSizeMB) {
+  // Largest power of two number of buckets, which fits into the size
+  const quint64 nBytes(static_cast<quint64>(qMax(nSizeMB, 1u)) << 20);
+  quint64 nBuckets(1);
+  while ((nBuckets << 1) * BucketSize * sizeof(Slot) <= nBytes) {
+    nBuckets <<= 1;
+  }
+
+  delete [] m_pSlots;
+  m_nBucketMask = nBuckets - 1;
+  m_nSlots = nBuckets * BucketSize;
+  m_pSlots = new Slot[m_nSlots];
+  this->clear();
+}
+
+quint32 TranspositionTable::getSizeMB() const {
+  return static_cast<quint32>((m_nSlots * sizeof(Slot)) >> 20);
+}
+
+void TranspositionTable::setReplacement(const Replacement replacement) {
+  m_Replacement = replacement;
+}
+
+TranspositionTable::Replacement TranspositionTable::getReplacement() const {
+  return m_Replacement;
+}
+
+void TranspositionTable::clear() {
+  for (quint64 i = 0; i < m_nSlots; i++) {
+    m_pSlots[i].nCheck.store(0);
+    m_pSlots[i].nData.store(0);
+  }
+  m_nAge = 0;
+}
+
+void TranspositionTable::newSearch() {
+  m_nAge = (m_nAge + 1) & 15;
+}
+
+// Used slots of the current search in permill (sampled)
+quint16 TranspositionTable::usage() const {
+  const int nSample(static_cast<int>(qMin(static_cast<quint64>(1000), m_nSlots)));
+  int nUsed(0);
+  for (int i = 0; i < nSample; i++) {
+    const quint64 nData(m_pSlots[i].nData.load());
+    if (0 != nData && m_nAge == ageOf(nData)) {
+      nUsed++;
+    }
+  }
+  return static_cast<quint16>(nUsed * 1000 / nSample);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+bool TranspositionTable::probe(const quint64 nKey, Entry *pEntry) const {
+  const Slot *pBucket(m_pSlots + (nKey & m_nBucketMask) * BucketSize);
+  for (int i = 0; i < BucketSize; i++) {
+    const quint64 nData(pBucket[i].nData.load());
+    if (0 != nData && nKey == (pBucket[i].nCheck.load() ^ nData)) {
+      *pEntry = unpack(nData);
+      return true;
+    }
+  }
+  return false;
+}
+
+// ---------------------------------------------------------------------------
+
+void TranspositionTable::store(const quint64 nKey, const Entry &entry) {
+  Slot *pBucket(m_pSlots + (nKey & m_nBucketMask) * BucketSize);
+  quint64 nData[BucketSize];
+  int nReplace(-1);
+
+  // Same position or an empty slot is always used first
+  for (int i = 0; i < BucketSize; i++) {
+    nData[i] = pBucket[i].nData.load();
+    if (0 == nData[i] || nKey == (pBucket[i].nCheck.load() ^ nData[i])) {
+      nReplace = i;
+      break;
+    }
+  }
+
+  if (nReplace < 0) {
+    switch (m_Replacement) {
+      case ReplaceAlways:
+        nReplace = (nKey >> 48) & (BucketSize - 1);
+        break;
+      case ReplaceDepth:
+        nReplace = 0;
+        for (int i = 1; i < BucketSize; i++) {
+          if (depthOf(nData[i]) < depthOf(nData[nReplace])) {
+            nReplace = i;
+          }
+        }
+        break;
+      default: {  // ReplaceDepthAge
+        int nWorst(0x7FFFFFFF);
+        for (int i = 0; i < BucketSize; i++) {
+          const int nValue(depthOf(nData[i]) -
+                           8 * ((m_nAge - ageOf(nData[i])) & 15));
+          if (nValue < nWorst) {
+            nWorst = nValue;
+            nReplace = i;
+          }
+        }
+        break;
+      }
+    }
+  }
+
+  Entry newEntry(entry);
+  // Keep a known best move, if the new result has none
+  const quint64 nOld(nData[nReplace]);
+  if (!newEntry.move.isValid() && 0 != nOld &&
+      nKey == (pBucket[nReplace].nCheck.load() ^ nOld)) {
+    newEntry.move = unpack(nOld).move;
+  }
+  const quint64 nNew(this->pack(newEntry));
+  pBucket[nReplace].nCheck.store(nKey ^ nNew);
+  pBucket[nReplace].nData.store(nNew);
+}
+
+// ---------------------------------------------------------------------------
+// ---------------------------------------------------------------------------
+
+quint64 TranspositionTable::pack(const Entry &entry) const {
+  return static_cast<quint64>(static_cast<quint32>(entry.nScore)) |
+      (static_cast<quint64>(static_cast<quint8>(entry.move.nFrom)) << 32) |
+      (static_cast<quint64>(static_cast<quint8>(entry.move.nTo)) << 40) |
+      (static_cast<quint64>(entry.move.nStones & 15) << 48) |
+      (static_cast<quint64>(qMin(static_cast<int>(entry.nDepth),
+                                 static_cast<int>(MaxDepth))) << 52) |
+      (static_cast<quint64>(entry.bound & 3) << 58) |
+      (static_cast<quint64>(m_nAge) << 60);
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(const quint64 nData) {
+  Entry entry;
+  entry.nScore = static_cast<qint32>(static_cast<quint32>(nData));
+  entry.move.nFrom = static_cast<qint8>((nData >> 32) & 0xFF);
+  entry.move.nTo = static_cast<qint8>((nData >> 40) & 0xFF);
+  entry.move.nStones = (nData >> 48) & 15;
+  entry.nDepth = depthOf(nData);
+  entry.bound = static_cast<Bound>((nData >> 58) & 3);
+  return entry;
+}
+
+quint8 TranspositionTable::depthOf(const quint64 nData) {
+  return (nData >> 52) & MaxDepth;
+}
+
+quint8 TranspositionTable::ageOf(const quint64 nData) {
+  return (nData >> 60) & 15;
+}
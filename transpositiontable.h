@@ -0,0 +1,102 @@
+/**
+ * \file transpositiontable.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for the search transposition table.
+ */
+
+#ifndef TRANSPOSITIONTABLE_H_
+#define TRANSPOSITIONTABLE_H_
+
+#include <QAtomicInteger>
+
+#include "./position.h"
+
+/**
+ * \class TranspositionTable
+ * \brief Fixed size hash table of search results, indexed by Zobrist key.
+ *
+ * The table is split into buckets of four 16 byte slots (one cache line).
+ * Which slot of a full bucket is overwritten is decided by the configured
+ * replacement policy. Memory usage never grows beyond the given size.
+ * The search uses canonical keys, so symmetric positions share a slot.
+ *
+ * Several search threads may probe / store concurrently without locking:
+ * a slot holds key XOR data, so a slot torn by a parallel write simply
+ * does not match any key anymore.
+ */
+class TranspositionTable {
+  public:
+    enum Bound { NoBound = 0, UpperBound, LowerBound, ExactBound };
+    enum Replacement {
+      ReplaceAlways = 0,  // Newest entry wins (slot chosen by key)
+      ReplaceDepth,       // Shallowest entry of the bucket is replaced
+      ReplaceDepthAge     // Like ReplaceDepth, old searches go first
+    };
+    enum { BucketSize = 4, MaxDepth = 63 };
+
+    struct Entry {
+      Entry() : nScore(0), nDepth(0), bound(NoBound) {}
+
+      Move move;
+      qint32 nScore;
+      quint8 nDepth;
+      Bound bound;
+    };
+
+    explicit TranspositionTable(const quint32 nSizeMB = 16,
+                                const Replacement replacement =
+                                ReplaceDepthAge);
+    ~TranspositionTable();
+
+    void resize(const quint32 nSizeMB);
+    quint32 getSizeMB() const;
+    void setReplacement(const Replacement replacement);
+    Replacement getReplacement() const;
+    void clear();
+    void newSearch();
+    quint16 usage() const;
+
+    bool probe(const quint64 nKey, Entry *pEntry) const;
+    void store(const quint64 nKey, const Entry &entry);
+
+  private:
+    Q_DISABLE_COPY(TranspositionTable)
+
+    struct Slot {
+      QAtomicInteger<quint64> nCheck;  // Key XOR data
+      QAtomicInteger<quint64> nData;
+    };
+
+    quint64 pack(const Entry &entry) const;
+    static Entry unpack(const quint64 nData);
+    static quint8 depthOf(const quint64 nData);
+    static quint8 ageOf(const quint64 nData);
+
+    Slot *m_pSlots;
+    quint64 m_nSlots;
+    quint64 m_nBucketMask;
+    Replacement m_Replacement;
+    quint8 m_nAge;
+};
+
+#endif  // TRANSPOSITIONTABLE_H_
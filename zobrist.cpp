@@ -0,0 +1,64 @@
+/**
+ * \file zobrist.cpp
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Zobrist hash keys.
+ */
+
+#include "./zobrist.h"
+
+const Zobrist Zobrist::s_Keys;
+
+namespace {
+// SplitMix64 - small, fast and good enough for hash keys
+quint64 nextKey(quint64 *pState) {
+  quint64 z(*pState += Q_UINT64_C(0x9E3779B97F4A7C15));
+  z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+  return z ^ (z >> 31);
+}
+}  // namespace
+
+Zobrist::Zobrist() {
+  quint64 nState(Q_UINT64_C(0x5374616B436F6E71));  // Fixed seed
+
+  for (int nField = 0; nField < Fields; nField++) {
+    for (int i = 0; i < (2 << Levels); i++) {
+      // Index 1 = height 0 (empty field)
+      m_nTower[nField][i] = (i < 2) ? 0 : nextKey(&nState);
+    }
+  }
+  m_nSide = nextKey(&nState);
+  for (int nPlayer = 0; nPlayer < 2; nPlayer++) {
+    for (int i = 0; i < Counts; i++) {
+      m_nStonesLeft[nPlayer][i] = (0 == i) ? 0 : nextKey(&nState);
+      m_nWonTowers[nPlayer][i] = (0 == i) ? 0 : nextKey(&nState);
+    }
+  }
+  for (int nFrom = 0; nFrom < Fields; nFrom++) {
+    for (int nTo = 0; nTo < Fields; nTo++) {
+      for (int i = 0; i <= Levels; i++) {
+        m_nPreviousMove[nFrom][nTo][i] = (0 == i) ? 0 : nextKey(&nState);
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/**
+ * \file zobrist.h
+ *
+ * \section LICENSE
+ *
+ * Copyright (C) 2015-2018 Thorsten Roth <elthoro@gmx.de>
+ *
+ * This file is part of StackAndConquer.
+ *
+ * StackAndConquer is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * StackAndConquer is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with StackAndConquer.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section DESCRIPTION
+ * Class definition for Zobrist hash keys.
+ */
+
+#ifndef ZOBRIST_H_
+#define ZOBRIST_H_
+
+#include <QtGlobal>
+
+/**
+ * \class Zobrist
+ * \brief Random 64 bit keys for incremental position hashing.
+ *
+ * The key of a position is the XOR of the keys of all towers, the side to
+ * move, the stones in hand, the won towers and the previous move (because
+ * of the revert rule). Empty fields / zero counts have key 0. Keys are
+ * generated from a fixed seed, so they are identical on every run and can
+ * be stored in files.
+ */
+class Zobrist {
+  public:
+    enum { Fields = 32, Levels = 4, Counts = 256 };
+
+    static quint64 tower(const qint8 nField, const quint8 nHeight,
+                         const quint8 nColors) {
+      return s_Keys.m_nTower[nField][(1 << nHeight) |
+                                     (nColors & ((1 << nHeight) - 1))];
+    }
+    static quint64 side() {
+      return s_Keys.m_nSide;
+    }
+    static quint64 stonesLeft(const quint8 nPlayer, const quint8 nStones) {
+      return s_Keys.m_nStonesLeft[nPlayer - 1][nStones];
+    }
+    static quint64 wonTowers(const quint8 nPlayer, const quint8 nWon) {
+      return s_Keys.m_nWonTowers[nPlayer - 1][nWon];
+    }
+    // Only tower moves are remembered as previous move
+    static quint64 previousMove(const qint8 nFrom, const qint8 nTo,
+                                const quint8 nStones) {
+      if (nFrom < 0 || nTo < 0) {
+        return 0;
+      }
+      return s_Keys.m_nPreviousMove[nFrom][nTo][nStones];
+    }
+
+  private:
+    Zobrist();
+
+    static const Zobrist s_Keys;
+
+    quint64 m_nTower[Fields][2 << Levels];
+    quint64 m_nSide;
+    quint64 m_nStonesLeft[2][Counts];
+    quint64 m_nWonTowers[2][Counts];
+    quint64 m_nPreviousMove[Fields][Fields][Levels + 1];
+};
+
+#endif  // ZOBRIST_H_